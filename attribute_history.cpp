@@ -0,0 +1,66 @@
+#include "attribute_history.h"
+#include <algorithm>
+
+namespace camellia {
+
+attribute_history::attribute_history(size_t capacity) : _entries(std::max<size_t>(capacity, 1)) {}
+
+size_t attribute_history::_upper_bound(number_t time) const {
+    size_t lo = 0;
+    size_t hi = _size;
+    while (lo < hi) {
+        const auto mid = lo + ((hi - lo) / 2);
+        if (_at(mid).time <= time) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+void attribute_history::record(number_t time, const variant &val) {
+    if (_size > 0 && _at(_size - 1).time >= time) {
+        truncate(time);
+        if (_size > 0 && _at(_size - 1).time == time) {
+            _at(_size - 1).value = val;
+            return;
+        }
+    }
+
+    if (_size == _entries.size()) {
+        _head = (_head + 1) % _entries.size();
+        _size--;
+    }
+    auto &e = _at(_size);
+    e.time = time;
+    e.value = val;
+    _size++;
+}
+
+const variant *attribute_history::sample(number_t time) const {
+    const auto count = _upper_bound(time);
+    if (count == 0) {
+        return nullptr;
+    }
+    const auto &value = _at(count - 1).value;
+    return value.get_value_type() == variant::VOID ? nullptr : &value;
+}
+
+void attribute_history::truncate(number_t time) {
+    const auto count = _upper_bound(time);
+    for (auto i = count; i < _size; i++) {
+        _at(i).value = variant();
+    }
+    _size = count;
+}
+
+void attribute_history::clear() {
+    for (auto &e : _entries) {
+        e.value = variant();
+    }
+    _head = 0;
+    _size = 0;
+}
+
+} // namespace camellia
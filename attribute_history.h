@@ -0,0 +1,45 @@
+#ifndef CAMELLIA_ATTRIBUTE_HISTORY_H
+#define CAMELLIA_ATTRIBUTE_HISTORY_H
+
+#include "camellia_typedef.h"
+#include "variant.h"
+#include <vector>
+
+namespace camellia {
+
+// Fixed-size ring of (time, value) samples of one attribute, ordered by time. Once full, the oldest sample is
+// overwritten. Recording at an earlier time than the latest sample drops the samples after it, so the ring stays
+// sorted after a rewind and lookups can binary search it.
+class attribute_history {
+public:
+    explicit attribute_history(size_t capacity);
+
+    void record(number_t time, const variant &val);
+    // The value recorded last at or before time; nullptr if time is older than the ring or the attribute was absent
+    [[nodiscard]] const variant *sample(number_t time) const;
+    // Drops every sample after time
+    void truncate(number_t time);
+    void clear();
+
+    [[nodiscard]] size_t get_size() const noexcept { return _size; }
+    [[nodiscard]] size_t get_capacity() const noexcept { return _entries.size(); }
+
+private:
+    struct entry {
+        number_t time{0.0F};
+        variant value;
+    };
+
+    std::vector<entry> _entries;
+    size_t _head{0};
+    size_t _size{0};
+
+    [[nodiscard]] const entry &_at(size_t i) const { return _entries[(_head + i) % _entries.size()]; }
+    [[nodiscard]] entry &_at(size_t i) { return _entries[(_head + i) % _entries.size()]; }
+    // Number of samples recorded at or before time
+    [[nodiscard]] size_t _upper_bound(number_t time) const;
+};
+
+} // namespace camellia
+
+#endif // CAMELLIA_ATTRIBUTE_HISTORY_H
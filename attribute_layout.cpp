@@ -0,0 +1,37 @@
+#include "attribute_layout.h"
+#include "data/stage_data.h"
+#include <algorithm>
+
+namespace camellia {
+
+attribute_layout::attribute_layout(std::vector<hash_t> &&keys) : _keys(std::move(keys)) {
+    std::sort(_keys.begin(), _keys.end());
+    _keys.erase(std::unique(_keys.begin(), _keys.end()), _keys.end());
+}
+
+attribute_layout::slot_t attribute_layout::find_slot(hash_t h_key) const {
+    auto it = std::lower_bound(_keys.begin(), _keys.end(), h_key);
+    return it != _keys.end() && *it == h_key ? static_cast<slot_t>(it - _keys.begin()) : INVALID_SLOT;
+}
+
+attribute_layout_map attribute_layout::compile(const std::map<hash_t, std::shared_ptr<actor_data>> &actors) {
+    std::unordered_map<hash_t, std::vector<hash_t>> keys_by_type;
+    for (const auto &[h_actor_id, p_actor] : actors) {
+        if (p_actor == nullptr) {
+            continue;
+        }
+        auto &keys = keys_by_type[p_actor->h_actor_type];
+        for (const auto &[h_key, value] : p_actor->default_attributes) {
+            keys.push_back(h_key);
+        }
+    }
+
+    attribute_layout_map layouts;
+    layouts.reserve(keys_by_type.size());
+    for (auto &[h_actor_type, keys] : keys_by_type) {
+        layouts.emplace(h_actor_type, std::make_shared<const attribute_layout>(std::move(keys)));
+    }
+    return layouts;
+}
+
+} // namespace camellia
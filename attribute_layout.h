@@ -0,0 +1,44 @@
+#ifndef CAMELLIA_ATTRIBUTE_LAYOUT_H
+#define CAMELLIA_ATTRIBUTE_LAYOUT_H
+
+#include "camellia_typedef.h"
+#include <map>
+#include <memory>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+namespace camellia {
+
+struct actor_data;
+class attribute_layout;
+
+// h_actor_type -> layout shared by every actor of that type
+using attribute_layout_map = std::unordered_map<hash_t, std::shared_ptr<const attribute_layout>>;
+
+// Fixed attribute slots shared by every actor of one type: the default_attributes keys of all actor_data with that
+// h_actor_type, sorted by key. Layers, timelines and registries bound to a layout address these attributes by slot.
+class attribute_layout {
+public:
+    using slot_t = uint32_t;
+    constexpr static slot_t INVALID_SLOT = ~0U;
+
+    attribute_layout() = default;
+    // Takes keys in any order, duplicates are dropped
+    explicit attribute_layout(std::vector<hash_t> &&keys);
+
+    [[nodiscard]] slot_t find_slot(hash_t h_key) const;
+    [[nodiscard]] hash_t get_key(slot_t slot) const { return _keys[slot]; }
+    [[nodiscard]] std::span<const hash_t> get_keys() const { return _keys; }
+    [[nodiscard]] size_t get_size() const { return _keys.size(); }
+
+    // One layout per h_actor_type found in actors
+    static attribute_layout_map compile(const std::map<hash_t, std::shared_ptr<actor_data>> &actors);
+
+private:
+    std::vector<hash_t> _keys;
+};
+
+} // namespace camellia
+
+#endif // CAMELLIA_ATTRIBUTE_LAYOUT_H
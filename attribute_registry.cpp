@@ -1,68 +1,507 @@
 ﻿
 #include "attribute_registry.h"
-#include <stdexcept>
+#include "helper/algorithm_helper.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <type_traits>
 
 namespace camellia {
 
+namespace {
+constexpr auto key_less = [](const auto &entry, hash_t h_key) { return entry.first < h_key; };
+
+template <size_t N> void quantize_components(std::array<number_t, N> &dim, number_t step) {
+    for (auto &d : dim) {
+        d = std::round(d / step) * step;
+    }
+}
+
+// Snaps NUMBER and vector values to multiples of step, other kinds are returned as they are
+variant quantize(const variant &val, number_t step) {
+    switch (val.get_value_type()) {
+    case variant::NUMBER:
+        return {std::round(static_cast<number_t>(val) / step) * step};
+    case variant::VECTOR2: {
+        auto vec = val.get_vector2();
+        quantize_components(vec.dim, step);
+        return {vec};
+    }
+    case variant::VECTOR3: {
+        auto vec = val.get_vector3();
+        quantize_components(vec.dim, step);
+        return {vec};
+    }
+    case variant::VECTOR4: {
+        auto vec = val.get_vector4();
+        quantize_components(vec.dim, step);
+        return {vec};
+    }
+    default:
+        return val;
+    }
+}
+
+template <size_t N> bool components_within(const std::array<number_t, N> &a, const std::array<number_t, N> &b, number_t threshold) {
+    for (size_t i = 0; i < N; i++) {
+        if (std::abs(a[i] - b[i]) > threshold) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool within_threshold(const variant &current, const variant &incoming, number_t threshold) {
+    if (current.get_value_type() != incoming.get_value_type()) {
+        return false;
+    }
+    switch (current.get_value_type()) {
+    case variant::INTEGER:
+        return static_cast<number_t>(std::abs(static_cast<integer_t>(current) - static_cast<integer_t>(incoming))) <= threshold;
+    case variant::NUMBER:
+        return std::abs(static_cast<number_t>(current) - static_cast<number_t>(incoming)) <= threshold;
+    case variant::VECTOR2:
+        return components_within(current.get_vector2().dim, incoming.get_vector2().dim, threshold);
+    case variant::VECTOR3:
+        return components_within(current.get_vector3().dim, incoming.get_vector3().dim, threshold);
+    case variant::VECTOR4:
+        return components_within(current.get_vector4().dim, incoming.get_vector4().dim, threshold);
+    default:
+        return false;
+    }
+}
+
+template <typename T> const T &get_vector(const variant &val) {
+    if constexpr (std::is_same_v<T, vector2>) {
+        return val.get_vector2();
+    } else if constexpr (std::is_same_v<T, vector3>) {
+        return val.get_vector3();
+    } else {
+        return val.get_vector4();
+    }
+}
+
+bool is_vector(variant::types type) { return type == variant::VECTOR2 || type == variant::VECTOR3 || type == variant::VECTOR4; }
+
+// The current value is stored quantized, so a change is insignificant if it quantizes to the same value or stays
+// within the threshold of the last reported value
+bool is_insignificant(const variant &current, const variant &incoming, const attribute_tolerance &tolerance) {
+    if (tolerance.quantization_step > 0.0F) {
+        const auto quantized = quantize(incoming, tolerance.quantization_step);
+        return quantized.approx_equals(current) || (tolerance.threshold > 0.0F && within_threshold(current, quantized, tolerance.threshold));
+    }
+    return tolerance.threshold > 0.0F && within_threshold(current, incoming, tolerance.threshold);
+}
+} // namespace
+
+const attribute_registry::slot *attribute_registry::_find(hash_t h_key) const {
+    auto it = std::lower_bound(_index.begin(), _index.end(), h_key, key_less);
+    if (it == _index.end() || it->first != h_key) {
+        return nullptr;
+    }
+    return &_slots[it->second];
+}
+
+uint32_t attribute_registry::_find_or_insert(hash_t h_key) {
+    auto it = std::lower_bound(_index.begin(), _index.end(), h_key, key_less);
+    if (it != _index.end() && it->first == h_key) {
+        return it->second;
+    }
+    const auto slot_index = _append_slot(h_key);
+    _index.emplace(it, h_key, slot_index);
+    _is_snapshot_index_stale = true;
+    return slot_index;
+}
+
+uint32_t attribute_registry::_append_slot(hash_t h_key) {
+    const auto slot_index = static_cast<uint32_t>(_slots.size());
+    auto &s = _slots.emplace_back();
+    const auto it = std::lower_bound(_tolerances.begin(), _tolerances.end(), h_key, key_less);
+    if (it != _tolerances.end() && it->first == h_key) {
+        _apply_tolerance(s, it->second);
+    }
+    if (_p_layout != nullptr) {
+        if (const auto layout_slot = _p_layout->find_slot(h_key); layout_slot != attribute_layout::INVALID_SLOT) {
+            _layout_slots[layout_slot] = slot_index;
+        }
+    }
+    return slot_index;
+}
+
+uint32_t attribute_registry::_find_or_insert_at(attribute_layout::slot_t slot) {
+    // A slot created here is recorded in _layout_slots by _append_slot
+    return _layout_slots[slot] != NO_SLOT ? _layout_slots[slot] : _find_or_insert(_p_layout->get_key(slot));
+}
+
+void attribute_registry::_apply_tolerance(slot &s, attribute_tolerance tolerance) {
+    s.tolerance = tolerance;
+    s.has_tolerance = tolerance.threshold > 0.0F || tolerance.quantization_step > 0.0F;
+}
+
+void attribute_registry::_mark_dirty(hash_t h_key, uint32_t slot_index) {
+    const auto chunk_index = slot_index / attribute_snapshot::CHUNK_SIZE;
+    if (chunk_index < _stale_snapshot_chunks.size()) {
+        _stale_snapshot_chunks[chunk_index] = true;
+    }
+
+    auto &s = _slots[slot_index];
+    if (!s.is_dirty) {
+        s.is_dirty = true;
+        _dirty_keys.push_back(h_key);
+        _dirty_slots.push_back(slot_index);
+    }
+}
+
+template <typename V> void attribute_registry::_assign(hash_t h_key, uint32_t slot_index, V &&val) {
+    const auto &s = _slots[slot_index];
+    if (s.is_present && s.value.approx_equals(val)) {
+        return;
+    }
+    _store(h_key, slot_index, std::forward<V>(val));
+}
+
+template <typename V> void attribute_registry::_store(hash_t h_key, uint32_t slot_index, V &&val) {
+    auto &s = _slots[slot_index];
+    if (s.is_present) {
+        if (s.has_tolerance && is_insignificant(s.value, val, s.tolerance)) [[unlikely]] {
+            _suppressed_change_count++;
+            return;
+        }
+    } else {
+        s.is_present = true;
+        _count++;
+    }
+
+    if (s.has_tolerance && s.tolerance.quantization_step > 0.0F) [[unlikely]] {
+        s.value = quantize(val, s.tolerance.quantization_step);
+    } else {
+        s.value = std::forward<V>(val);
+    }
+    _mark_dirty(h_key, slot_index);
+}
+
 void attribute_registry::add(hash_t h_key, const variant &val) {
-    if (_attributes.contains(h_key)) {
+    const auto slot_index = _find_or_insert(h_key);
+    auto &s = _slots[slot_index];
+    if (s.is_present) {
         return;
     }
-    _attributes[h_key] = val;
-    _dirty_attributes.insert(h_key);
+    s.is_present = true;
+    s.value = val;
+    _count++;
+    _mark_dirty(h_key, slot_index);
 }
 
-boolean_t attribute_registry::contains_key(hash_t h_key) { return _attributes.contains(h_key); }
+boolean_t attribute_registry::contains_key(hash_t h_key) { return get(h_key) != nullptr; }
 
 boolean_t attribute_registry::remove(hash_t h_key) {
-    auto removed = _attributes.erase(h_key);
-    if (removed <= 0) {
+    auto it = std::lower_bound(_index.begin(), _index.end(), h_key, key_less);
+    if (it == _index.end() || it->first != h_key || !_slots[it->second].is_present) {
         return false;
     }
-    _dirty_attributes.insert(h_key);
+    auto &s = _slots[it->second];
+    s.is_present = false;
+    s.value = variant();
+    _count--;
+    _mark_dirty(h_key, it->second);
     return true;
 }
 
 void attribute_registry::clear() {
-    for (auto &p : _attributes) {
-        _dirty_attributes.insert(p.first);
+    for (const auto &[h_key, slot_index] : _index) {
+        auto &s = _slots[slot_index];
+        if (s.is_present) {
+            s.is_present = false;
+            s.value = variant();
+            _mark_dirty(h_key, slot_index);
+        }
     }
-
-    _attributes.clear();
+    _count = 0;
 }
 
-size_t attribute_registry::get_count() const { return _attributes.size(); }
+size_t attribute_registry::get_count() const { return _count; }
 
 void attribute_registry::reset() {
-    _dirty_attributes.clear();
-    _attributes.clear();
+    _index.clear();
+    _slots.clear();
+    _tolerances.clear();
+    _dirty_keys.clear();
+    _dirty_slots.clear();
+    _count = 0;
+    _suppressed_change_count = 0;
+    _history_capacity = 0;
+    _last_record_time = 0.0F;
+    _p_snapshot = nullptr;
+    _stale_snapshot_chunks.clear();
+    _is_snapshot_index_stale = true;
+    _p_layout = nullptr;
+    _layout_slots.clear();
 }
 
-void attribute_registry::update(const std::map<hash_t, variant> &values) {
-    for (const auto &p : values) {
-        this->set(p.first, p.second);
+void attribute_registry::clear_dirty_attributes() {
+    for (const auto slot_index : _dirty_slots) {
+        _slots[slot_index].is_dirty = false;
     }
+    _dirty_keys.clear();
+    _dirty_slots.clear();
 }
 
+template <typename T> void attribute_registry::_assign_vector_run() {
+    auto &[old_values, new_values] = std::get<vector_batch<T>>(_vector_batches);
+    old_values.clear();
+    new_values.clear();
+    for (const auto &update : _vector_run) {
+        old_values.push_back(get_vector<T>(_slots[update.slot_index].value));
+        new_values.push_back(get_vector<T>(*update.p_value));
+    }
+
+    std::array<boolean_t, VECTOR_BATCH_SIZE> is_equal{};
+    algorithm_helper::approx_equals_batch(std::span<const T>(old_values), std::span<const T>(new_values), std::span(is_equal.data(), _vector_run.size()));
+    // Vectors live inline in the variant, so storing a copy costs the same as moving
+    for (size_t k = 0; k < _vector_run.size(); k++) {
+        if (!is_equal[k]) {
+            _store(_vector_run[k].h_key, _vector_run[k].slot_index, *_vector_run[k].p_value);
+        }
+    }
+    _vector_run.clear();
+}
+
+template <typename M> void attribute_registry::_merge_update(M &values) {
+    // Both sides are sorted by key. Keys missing from the index are appended behind it and merged in afterwards.
+    const auto index_size = _index.size();
+    size_t i = 0;
+    // Consecutive updates of one vector kind are compared in a batch; they are flushed before any other update so
+    // attributes still become dirty in key order
+    auto run_type = variant::VOID;
+    auto flush_run = [&]() {
+        switch (run_type) {
+        case variant::VECTOR2:
+            _assign_vector_run<vector2>();
+            break;
+        case variant::VECTOR3:
+            _assign_vector_run<vector3>();
+            break;
+        case variant::VECTOR4:
+            _assign_vector_run<vector4>();
+            break;
+        default:
+            break;
+        }
+        run_type = variant::VOID;
+    };
+    // A layer with the registry's layout hands over layout slots, which map straight to storage once written
+    auto uses_layout_slots = false;
+    if constexpr (std::is_same_v<std::remove_const_t<M>, frame_attribute_layer>) {
+        uses_layout_slots = _p_layout != nullptr && values.get_layout() == _p_layout.get();
+    }
+    auto merge = [&](hash_t h_key, auto &value, attribute_layout::slot_t layout_slot = attribute_layout::INVALID_SLOT) {
+        auto slot_index = NO_SLOT;
+        if (uses_layout_slots && layout_slot != attribute_layout::INVALID_SLOT) {
+            slot_index = _layout_slots[layout_slot];
+        }
+        if (slot_index == NO_SLOT) {
+            while (i < index_size && _index[i].first < h_key) {
+                i++;
+            }
+            if (i < index_size && _index[i].first == h_key) {
+                slot_index = _index[i].second;
+            } else {
+                slot_index = _append_slot(h_key);
+                _index.emplace_back(h_key, slot_index);
+            }
+        }
+
+        const auto &s = _slots[slot_index];
+        const auto type = value.get_value_type();
+        if (s.is_present && is_vector(type) && s.value.get_value_type() == type) {
+            if (type != run_type || _vector_run.size() == VECTOR_BATCH_SIZE) {
+                flush_run();
+                run_type = type;
+            }
+            _vector_run.push_back({h_key, slot_index, &value});
+            return;
+        }
+
+        flush_run();
+        if constexpr (std::is_const_v<std::remove_reference_t<decltype(value)>>) {
+            _assign(h_key, slot_index, value);
+        } else {
+            _assign(h_key, slot_index, std::move(value));
+        }
+    };
+
+    if constexpr (std::is_same_v<std::remove_const_t<M>, frame_attribute_layer>) {
+        values.for_each_slot(merge);
+    } else {
+        for (auto &[h_key, value] : values) {
+            merge(h_key, value);
+        }
+    }
+    flush_run();
+
+    if (_index.size() != index_size) {
+        _is_snapshot_index_stale = true;
+        std::inplace_merge(_index.begin(), _index.begin() + static_cast<std::ptrdiff_t>(index_size), _index.end(),
+                           [](const auto &a, const auto &b) { return a.first < b.first; });
+    }
+}
+
+void attribute_registry::update(const frame_attribute_map &values) { _merge_update(values); }
+
+void attribute_registry::update(frame_attribute_map &&values) { _merge_update(values); }
+
+void attribute_registry::update(const frame_attribute_layer &values) { _merge_update(values); }
+
+void attribute_registry::update(frame_attribute_layer &&values) { _merge_update(values); }
+
 const variant *attribute_registry::get(hash_t h_key) const {
-    try {
-        return &_attributes.at(h_key);
-    } catch (std::out_of_range &) {
+    const auto *p_slot = _find(h_key);
+    return p_slot != nullptr && p_slot->is_present ? &p_slot->value : nullptr;
+}
+
+void attribute_registry::set(hash_t h_key, const variant &val) { _assign(h_key, _find_or_insert(h_key), val); }
+
+void attribute_registry::set(hash_t h_key, variant &&val) { _assign(h_key, _find_or_insert(h_key), std::move(val)); }
+
+void attribute_registry::bind_layout(std::shared_ptr<const attribute_layout> p_layout) {
+    if (p_layout == _p_layout) {
+        return;
+    }
+    _p_layout = std::move(p_layout);
+    _layout_slots.clear();
+    if (_p_layout == nullptr) {
+        return;
+    }
+
+    // Keys held already keep their slots; both lists are sorted, so one pass finds them
+    _layout_slots.assign(_p_layout->get_size(), NO_SLOT);
+    size_t i = 0;
+    for (attribute_layout::slot_t slot = 0; slot < _layout_slots.size(); slot++) {
+        const auto h_key = _p_layout->get_key(slot);
+        while (i < _index.size() && _index[i].first < h_key) {
+            i++;
+        }
+        if (i < _index.size() && _index[i].first == h_key) {
+            _layout_slots[slot] = _index[i].second;
+        }
+    }
+}
+
+const variant *attribute_registry::get_at(attribute_layout::slot_t slot) const {
+    if (slot >= _layout_slots.size() || _layout_slots[slot] == NO_SLOT) {
         return nullptr;
     }
+    const auto &s = _slots[_layout_slots[slot]];
+    return s.is_present ? &s.value : nullptr;
 }
 
-void attribute_registry::set(hash_t h_key, const variant &val) {
-    if (!_attributes.contains(h_key) || !_attributes[h_key].approx_equals(val)) {
-        _dirty_attributes.insert(h_key);
-        _attributes[h_key] = val;
+void attribute_registry::set_at(attribute_layout::slot_t slot, const variant &val) {
+    if (slot >= _layout_slots.size()) {
+        return;
     }
+    _assign(_p_layout->get_key(slot), _find_or_insert_at(slot), val);
 }
 
-void attribute_registry::set(hash_t h_key, variant &&val) {
-    if (!_attributes.contains(h_key) || !_attributes[h_key].approx_equals(val)) {
-        _dirty_attributes.insert(h_key);
-        _attributes[h_key] = std::move(val);
+void attribute_registry::set_at(attribute_layout::slot_t slot, variant &&val) {
+    if (slot >= _layout_slots.size()) {
+        return;
     }
+    _assign(_p_layout->get_key(slot), _find_or_insert_at(slot), std::move(val));
+}
+
+void attribute_registry::set_tolerance(hash_t h_key, attribute_tolerance tolerance) {
+    // Kept aside so configuring a key does not give it a slot; slots pick it up when the key first appears
+    auto it = std::lower_bound(_tolerances.begin(), _tolerances.end(), h_key, key_less);
+    if (it != _tolerances.end() && it->first == h_key) {
+        it->second = tolerance;
+    } else {
+        _tolerances.emplace(it, h_key, tolerance);
+    }
+
+    const auto index_it = std::lower_bound(_index.begin(), _index.end(), h_key, key_less);
+    if (index_it != _index.end() && index_it->first == h_key) {
+        _apply_tolerance(_slots[index_it->second], tolerance);
+    }
+}
+
+void attribute_registry::enable_history(size_t capacity) {
+    if (capacity == _history_capacity) {
+        return;
+    }
+    _history_capacity = capacity;
+    _last_record_time = 0.0F;
+    for (auto &s : _slots) {
+        s.p_history = nullptr;
+    }
+}
+
+void attribute_registry::record_history(number_t time) {
+    if (_history_capacity == 0) {
+        return;
+    }
+
+    // After a rewind, samples past the new time belong to a timeline that no longer exists
+    if (time < _last_record_time) {
+        for (auto &s : _slots) {
+            if (s.p_history != nullptr) {
+                s.p_history->truncate(time);
+            }
+        }
+    }
+    _last_record_time = time;
+
+    for (const auto slot_index : _dirty_slots) {
+        auto &s = _slots[slot_index];
+        if (s.p_history == nullptr) {
+            s.p_history = std::make_unique<attribute_history>(_history_capacity);
+        }
+        s.p_history->record(time, s.is_present ? s.value : variant());
+    }
+}
+
+const variant *attribute_registry::get_at_time(hash_t h_key, number_t time) const {
+    const auto *p_slot = _find(h_key);
+    if (p_slot == nullptr || p_slot->p_history == nullptr) {
+        return nullptr;
+    }
+    return p_slot->p_history->sample(time);
+}
+
+std::shared_ptr<const attribute_snapshot> attribute_registry::take_snapshot() {
+    constexpr auto chunk_size = attribute_snapshot::CHUNK_SIZE;
+    const auto chunk_count = (_slots.size() + chunk_size - 1) / chunk_size;
+    const auto *p_previous = _p_snapshot.get();
+    if (p_previous != nullptr && !_is_snapshot_index_stale && std::ranges::none_of(_stale_snapshot_chunks, [](bool stale) { return stale; })) {
+        return _p_snapshot;
+    }
+
+    auto p_next = std::make_shared<attribute_snapshot>();
+    p_next->_version = ++_snapshot_version;
+    p_next->_count = _count;
+    p_next->_p_index = p_previous != nullptr && !_is_snapshot_index_stale ? p_previous->_p_index : std::make_shared<const attribute_snapshot::index_t>(_index);
+
+    p_next->_chunks.reserve(chunk_count);
+    for (size_t c = 0; c < chunk_count; c++) {
+        if (p_previous != nullptr && c < p_previous->_chunks.size() && !_stale_snapshot_chunks[c]) {
+            p_next->_chunks.push_back(p_previous->_chunks[c]);
+            continue;
+        }
+
+        auto p_chunk = std::make_shared<attribute_snapshot::chunk>();
+        const auto end = std::min(_slots.size(), (c + 1) * chunk_size);
+        for (auto slot_index = c * chunk_size; slot_index < end; slot_index++) {
+            const auto &s = _slots[slot_index];
+            if (s.is_present) {
+                p_chunk->values[slot_index % chunk_size] = s.value;
+                p_chunk->present.set(slot_index % chunk_size);
+            }
+        }
+        p_next->_chunks.push_back(std::move(p_chunk));
+    }
+
+    _stale_snapshot_chunks.assign(chunk_count, false);
+    _is_snapshot_index_stale = false;
+    _p_snapshot = std::move(p_next);
+    return _p_snapshot;
 }
-} // namespace camellia
\ No newline at end of file
+} // namespace camellia
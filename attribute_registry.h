@@ -1,11 +1,19 @@
 #ifndef CAMELLIA_ATTRIBUTE_REGISTRY_H
 #define CAMELLIA_ATTRIBUTE_REGISTRY_H
 
+#include "attribute_history.h"
+#include "attribute_layout.h"
+#include "attribute_snapshot.h"
 #include "camellia_typedef.h"
+#include "frame_arena.h"
 #include "manager.h"
 #include "variant.h"
-#include <map>
-#include <unordered_set>
+#include <deque>
+#include <memory>
+#include <span>
+#include <tuple>
+#include <utility>
+#include <vector>
 
 namespace camellia {
 class attribute_registry {
@@ -18,17 +26,106 @@ public:
     void clear();
     [[nodiscard]] size_t get_count() const;
     void reset();
-    [[nodiscard]] const std::unordered_set<hash_t> &peek_dirty_attributes() const { return _dirty_attributes; }
-    void clear_dirty_attributes() { _dirty_attributes.clear(); }
-    void update(const std::map<hash_t, variant> &values);
+    // Keys touched since the last clear_dirty_attributes(), each listed once, in the order they were first touched
+    [[nodiscard]] std::span<const hash_t> peek_dirty_attributes() const { return _dirty_keys; }
+    void clear_dirty_attributes();
+    // Merge-joins values against the sorted key index in one pass; the rvalue overload moves values in
+    void update(const frame_attribute_map &values);
+    void update(frame_attribute_map &&values);
+    void update(const frame_attribute_layer &values);
+    void update(frame_attribute_layer &&values);
 
     void set(hash_t h_key, variant &&val);
 
+    // Addresses the layout's keys by slot from now on. Slots are only reserved when a key is first written, so keys
+    // that are never set take no space; existing values and pointers from get() are kept.
+    void bind_layout(std::shared_ptr<const attribute_layout> p_layout);
+    [[nodiscard]] const attribute_layout *get_layout() const { return _p_layout.get(); }
+    // Access by slot of the bound layout, no lookup involved
+    [[nodiscard]] const variant *get_at(attribute_layout::slot_t slot) const;
+    void set_at(attribute_layout::slot_t slot, const variant &val);
+    void set_at(attribute_layout::slot_t slot, variant &&val);
+
+    // Changes within the tolerance of the current value are dropped instead of marking the attribute dirty
+    void set_tolerance(hash_t h_key, attribute_tolerance tolerance);
+    // Changes dropped by tolerances since the last reset()
+    [[nodiscard]] size_t get_suppressed_change_count() const { return _suppressed_change_count; }
+
+    // Keeps the last capacity changes of every attribute; 0 turns history off and drops what was recorded
+    void enable_history(size_t capacity);
+    [[nodiscard]] boolean_t has_history() const { return _history_capacity > 0; }
+    // Records the value of every dirty attribute at time; call before clear_dirty_attributes()
+    void record_history(number_t time);
+    // The value an attribute had at a recorded past time, nullptr if it was absent or time predates its history
+    [[nodiscard]] const variant *get_at_time(hash_t h_key, number_t time) const;
+
+    // The current contents as an immutable snapshot. Returns the previous snapshot if nothing changed since, otherwise a
+    // new version that shares every unchanged chunk with it.
+    [[nodiscard]] std::shared_ptr<const attribute_snapshot> take_snapshot();
+
 private:
-    std::map<hash_t, variant> _attributes;
-    std::unordered_set<hash_t> _dirty_attributes;
+    // Slots are never moved or freed before reset(), so pointers returned by get() survive later inserts
+    struct slot {
+        variant value;
+        boolean_t is_present{false};
+        boolean_t is_dirty{false};
+        boolean_t has_tolerance{false};
+        attribute_tolerance tolerance;
+        std::unique_ptr<attribute_history> p_history;
+    };
+
+    // A vector update whose slot already holds a vector of the same kind, waiting to be compared in a batch
+    struct vector_update {
+        hash_t h_key;
+        uint32_t slot_index;
+        const variant *p_value;
+    };
+    template <typename T> struct vector_batch {
+        std::vector<T> old_values;
+        std::vector<T> new_values;
+    };
+    static constexpr size_t VECTOR_BATCH_SIZE = 64;
+
+    // (key, index into _slots), sorted by key
+    std::vector<std::pair<hash_t, uint32_t>> _index;
+    std::deque<slot> _slots;
+    // (key, tolerance), sorted by key; copied into a slot when it is created
+    std::vector<std::pair<hash_t, attribute_tolerance>> _tolerances;
+    std::vector<hash_t> _dirty_keys;
+    std::vector<uint32_t> _dirty_slots;
+    size_t _count{0};
+    size_t _suppressed_change_count{0};
+    size_t _history_capacity{0};
+    number_t _last_record_time{0.0F};
+
+    std::shared_ptr<const attribute_snapshot> _p_snapshot;
+    // Chunks of the last snapshot that were written since, and whether keys were added to _index since
+    std::vector<bool> _stale_snapshot_chunks;
+    boolean_t _is_snapshot_index_stale{true};
+    uint64_t _snapshot_version{0};
+
+    std::shared_ptr<const attribute_layout> _p_layout;
+    // Layout slot -> index into _slots, NO_SLOT until the key is first written
+    std::vector<uint32_t> _layout_slots;
+    static constexpr uint32_t NO_SLOT = ~0U;
+
+    // Scratch space for _merge_update, kept to reuse its capacity
+    std::vector<vector_update> _vector_run;
+    std::tuple<vector_batch<vector2>, vector_batch<vector3>, vector_batch<vector4>> _vector_batches;
+
+    [[nodiscard]] const slot *_find(hash_t h_key) const;
+    uint32_t _find_or_insert(hash_t h_key);
+    uint32_t _append_slot(hash_t h_key);
+    uint32_t _find_or_insert_at(attribute_layout::slot_t slot);
+    static void _apply_tolerance(slot &s, attribute_tolerance tolerance);
+    void _mark_dirty(hash_t h_key, uint32_t slot_index);
+    template <typename V> void _assign(hash_t h_key, uint32_t slot_index, V &&val);
+    // _assign for a value already known to differ from the current one
+    template <typename V> void _store(hash_t h_key, uint32_t slot_index, V &&val);
+    template <typename T> void _assign_vector_run();
+    template <typename M> void _merge_update(M &values);
 };
 
 } // namespace camellia
 
-#endif // CAMELLIA_ATTRIBUTE_REGISTRY_H
\ No newline at end of file
+#endif // CAMELLIA_ATTRIBUTE_REGISTRY_H
@@ -0,0 +1,17 @@
+#include "attribute_snapshot.h"
+#include <algorithm>
+
+namespace camellia {
+
+const variant *attribute_snapshot::get(hash_t h_key) const {
+    if (_p_index == nullptr) {
+        return nullptr;
+    }
+    auto it = std::lower_bound(_p_index->begin(), _p_index->end(), h_key, [](const auto &entry, hash_t h) { return entry.first < h; });
+    if (it == _p_index->end() || it->first != h_key) {
+        return nullptr;
+    }
+    return _get_at(it->second);
+}
+
+} // namespace camellia
@@ -0,0 +1,60 @@
+#ifndef CAMELLIA_ATTRIBUTE_SNAPSHOT_H
+#define CAMELLIA_ATTRIBUTE_SNAPSHOT_H
+
+#include "camellia_typedef.h"
+#include "variant.h"
+#include <array>
+#include <bitset>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace camellia {
+
+class attribute_registry;
+
+// Immutable copy of a registry's attributes at one version. Values are stored in fixed-size chunks by registry slot;
+// a new snapshot copies only the chunks written since the previous one and shares the rest, as well as the key index
+// when no key was added. Readers may keep a snapshot for as long as they like while the registry moves on.
+class attribute_snapshot {
+public:
+    constexpr static size_t CHUNK_SIZE = 32;
+
+    [[nodiscard]] uint64_t get_version() const noexcept { return _version; }
+    [[nodiscard]] const variant *get(hash_t h_key) const;
+    [[nodiscard]] size_t get_count() const noexcept { return _count; }
+
+    // Calls f(h_key, value) for every present attribute, in key order
+    template <typename F> void for_each(F &&f) const {
+        for (const auto &[h_key, slot_index] : *_p_index) {
+            const auto *p_value = _get_at(slot_index);
+            if (p_value != nullptr) {
+                f(h_key, *p_value);
+            }
+        }
+    }
+
+private:
+    friend class attribute_registry;
+
+    struct chunk {
+        std::array<variant, CHUNK_SIZE> values;
+        std::bitset<CHUNK_SIZE> present;
+    };
+    using index_t = std::vector<std::pair<hash_t, uint32_t>>;
+
+    uint64_t _version{0};
+    size_t _count{0};
+    std::shared_ptr<const index_t> _p_index;
+    std::vector<std::shared_ptr<const chunk>> _chunks;
+
+    [[nodiscard]] const variant *_get_at(uint32_t slot_index) const {
+        const auto &p_chunk = _chunks[slot_index / CHUNK_SIZE];
+        const auto offset = slot_index % CHUNK_SIZE;
+        return p_chunk->present.test(offset) ? &p_chunk->values[offset] : nullptr;
+    }
+};
+
+} // namespace camellia
+
+#endif // CAMELLIA_ATTRIBUTE_SNAPSHOT_H
@@ -0,0 +1,23 @@
+#include "attribute_value_log.h"
+
+namespace camellia {
+
+const variant *attribute_value_log::append(const variant &value) {
+    const auto chunk_index = _size / CHUNK_SIZE;
+    if (chunk_index == _chunks.size()) {
+        _chunks.push_back(std::make_unique<chunk>());
+    }
+    auto &slot = (*_chunks[chunk_index])[_size % CHUNK_SIZE];
+    slot = value;
+    _size++;
+    return &slot;
+}
+
+void attribute_value_log::clear() {
+    for (size_t i = 0; i < _size; i++) {
+        (*_chunks[i / CHUNK_SIZE])[i % CHUNK_SIZE] = variant();
+    }
+    _size = 0;
+}
+
+} // namespace camellia
@@ -0,0 +1,33 @@
+#ifndef CAMELLIA_ATTRIBUTE_VALUE_LOG_H
+#define CAMELLIA_ATTRIBUTE_VALUE_LOG_H
+
+#include "camellia_typedef.h"
+#include "variant.h"
+#include <array>
+#include <memory>
+#include <vector>
+
+namespace camellia {
+
+// Append-only copies of the attribute values reported by dirty events. Values are stored in fixed-size chunks that are
+// never moved, so pointers returned by append() stay valid, even for a reader on another thread, until clear().
+// Copying a variant only bumps the reference count of its heap payload, if it has one.
+class attribute_value_log {
+public:
+    constexpr static size_t CHUNK_SIZE = 256;
+
+    const variant *append(const variant &value);
+    // Releases the values but keeps the chunks for the next frame
+    void clear();
+    [[nodiscard]] size_t get_size() const noexcept { return _size; }
+
+private:
+    using chunk = std::array<variant, CHUNK_SIZE>;
+
+    std::vector<std::unique_ptr<chunk>> _chunks;
+    size_t _size{0};
+};
+
+} // namespace camellia
+
+#endif // CAMELLIA_ATTRIBUTE_VALUE_LOG_H
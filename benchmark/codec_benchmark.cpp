@@ -0,0 +1,137 @@
+#include "message_generated.h"
+#include "variant.h"
+#include <benchmark/benchmark.h>
+#include <flatbuffers/flatbuffer_builder.h>
+#include <map>
+#include <vector>
+
+using namespace camellia;
+
+namespace {
+
+enum sample_kind : int64_t { SAMPLE_INTEGER, SAMPLE_NUMBER, SAMPLE_VECTOR3, SAMPLE_ATTRIBUTES };
+
+// Shapes that dominate IPC and snapshots: bare scalars and a dictionary of mixed attributes
+variant make_sample(int64_t kind) {
+    switch (kind) {
+    case SAMPLE_INTEGER:
+        return {42};
+    case SAMPLE_NUMBER:
+        return {0.1F};
+    case SAMPLE_VECTOR3:
+        return {vector3(1.5F, -2.25F, 0.1F)};
+    default: {
+        variant_dictionary dict;
+        for (integer_t i = 0; i < 16; i++) {
+            dict[variant(i)] = (i % 2 == 0) ? variant(vector3(static_cast<number_t>(i), 0.5F, -1.0F)) : variant(text_t("attribute"));
+        }
+        return {std::move(dict)};
+    }
+    }
+}
+
+void bm_encode_desc(benchmark::State &state) {
+    const auto v = make_sample(state.range(0));
+    text_t out;
+    for (auto _ : state) {
+        out.clear();
+        v.to_desc(out);
+        benchmark::DoNotOptimize(out.data());
+    }
+    state.counters["encoded_bytes"] = static_cast<double>(out.size());
+}
+
+void bm_encode_flatbuffers(benchmark::State &state) {
+    const auto v = make_sample(state.range(0));
+    flatbuffers::FlatBufferBuilder builder;
+    for (auto _ : state) {
+        builder.Clear();
+        builder.Finish(v.to_flatbuffers(builder));
+        benchmark::DoNotOptimize(builder.GetBufferPointer());
+    }
+    state.counters["encoded_bytes"] = static_cast<double>(builder.GetSize());
+}
+
+void bm_encode_binary(benchmark::State &state) {
+    const auto v = make_sample(state.range(0));
+    bytes_t out;
+    for (auto _ : state) {
+        out.clear();
+        v.to_binary(out);
+        benchmark::DoNotOptimize(out.data());
+    }
+    state.counters["encoded_bytes"] = static_cast<double>(out.size());
+}
+
+void bm_decode_desc(benchmark::State &state) {
+    const auto encoded = make_sample(state.range(0)).to_desc();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(variant::from_desc(encoded));
+    }
+}
+
+void bm_decode_flatbuffers(benchmark::State &state) {
+    flatbuffers::FlatBufferBuilder builder;
+    builder.Finish(make_sample(state.range(0)).to_flatbuffers(builder));
+    const auto *p_fb = flatbuffers::GetRoot<fb::Variant>(builder.GetBufferPointer());
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(variant::from_flatbuffers(*p_fb));
+    }
+}
+
+void bm_decode_binary(benchmark::State &state) {
+    const auto encoded = make_sample(state.range(0)).to_binary();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(variant::from_binary(encoded));
+    }
+}
+
+// Fixed-size kinds as one-field tables, the layout written before the struct members of fb::VariantData existed.
+flatbuffers::Offset<fb::Variant> legacy_to_flatbuffers(const variant &v, flatbuffers::FlatBufferBuilder &builder) {
+    switch (v.get_value_type()) {
+    case variant::INTEGER:
+        return fb::CreateVariant(builder, fb::VariantData_integer_value, fb::CreateInt32Value(builder, static_cast<integer_t>(v)).o);
+    case variant::NUMBER:
+        return fb::CreateVariant(builder, fb::VariantData_number_value, fb::CreateFloatValue(builder, static_cast<number_t>(v)).o);
+    case variant::VECTOR3: {
+        const auto &vec = v.get_vector3();
+        return fb::CreateVariant(builder, fb::VariantData_vector3_value, fb::CreateVector3(builder, vec.get_x(), vec.get_y(), vec.get_z()).o);
+    }
+    default:
+        return v.to_flatbuffers(builder);
+    }
+}
+
+// A NodeAttributeDirtyEvent carrying range(0) attributes of the usual position/scale/alpha mix
+template <bool Legacy> void bm_encode_dirty_event(benchmark::State &state) {
+    std::vector<std::pair<hash_t, variant>> dirty_attributes;
+    for (int64_t i = 0; i < state.range(0); i++) {
+        dirty_attributes.emplace_back(static_cast<hash_t>(i), (i % 3 == 2) ? variant(0.5F) : variant(vector3(static_cast<number_t>(i), 1.0F, 0.0F)));
+    }
+
+    flatbuffers::FlatBufferBuilder builder;
+    for (auto _ : state) {
+        builder.Clear();
+        auto base_node = fb::CreateNodeEvent(builder, 1ULL);
+        std::vector<flatbuffers::Offset<fb::AttributeValuePair>> pairs;
+        pairs.reserve(dirty_attributes.size());
+        for (const auto &[h_key, value] : dirty_attributes) {
+            auto value_offset = Legacy ? legacy_to_flatbuffers(value, builder) : value.to_flatbuffers(builder);
+            pairs.push_back(fb::CreateAttributeValuePair(builder, h_key, value_offset));
+        }
+        builder.Finish(fb::CreateNodeAttributeDirtyEvent(builder, base_node, builder.CreateVector(pairs)));
+        benchmark::DoNotOptimize(builder.GetBufferPointer());
+    }
+    state.counters["bytes_per_event"] = static_cast<double>(builder.GetSize());
+}
+
+} // namespace
+
+BENCHMARK(bm_encode_desc)->DenseRange(SAMPLE_INTEGER, SAMPLE_ATTRIBUTES);
+BENCHMARK(bm_encode_flatbuffers)->DenseRange(SAMPLE_INTEGER, SAMPLE_ATTRIBUTES);
+BENCHMARK(bm_encode_binary)->DenseRange(SAMPLE_INTEGER, SAMPLE_ATTRIBUTES);
+BENCHMARK(bm_decode_desc)->DenseRange(SAMPLE_INTEGER, SAMPLE_ATTRIBUTES);
+BENCHMARK(bm_decode_flatbuffers)->DenseRange(SAMPLE_INTEGER, SAMPLE_ATTRIBUTES);
+BENCHMARK(bm_decode_binary)->DenseRange(SAMPLE_INTEGER, SAMPLE_ATTRIBUTES);
+BENCHMARK(bm_encode_dirty_event<false>)->Arg(1)->Arg(8)->Arg(32);
+BENCHMARK(bm_encode_dirty_event<true>)->Arg(1)->Arg(8)->Arg(32);
@@ -0,0 +1,528 @@
+#include "helper/algorithm_helper.h"
+#include "variant.h"
+#include <benchmark/benchmark.h>
+#include <format>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace camellia;
+
+namespace {
+
+// The previous substring-based parser, kept as a baseline.
+variant legacy_from_desc(const text_t &descriptor) {
+    if (descriptor.empty()) {
+        return {}; // VOID
+    }
+
+    char type_char = descriptor[0];
+
+    switch (type_char) {
+    case variant::VOID_PREFIX: // VOID
+        return {};
+
+    case variant::INTEGER_PREFIX: { // INTEGER
+        if (descriptor.size() <= 1) {
+            return {0};
+        }
+
+        // Find base suffix (D=decimal, H=hex, O=octal, B=binary)
+        char base_suffix = descriptor.back();
+
+        int base = 10;
+        size_t len{descriptor.size() - 2};
+        switch (base_suffix) {
+        case 'H':
+            base = 16;
+            break;
+        case 'O':
+            base = 8;
+            break;
+        case 'B':
+            base = 2;
+            break;
+        case 'D':
+            break;
+        default:
+            // No suffix, assume entire content is decimal
+            len = descriptor.size() - 1;
+            break;
+        }
+
+        try {
+            return {static_cast<integer_t>(std::stol(descriptor.substr(1, len), nullptr, base))};
+        } catch (...) {
+            return {0};
+        }
+    }
+
+    case variant::NUMBER_PREFIX: { // NUMBER (floating point)
+        try {
+            return {std::stof(descriptor.substr(1))};
+        } catch (...) {
+            return {0.0F};
+        }
+    }
+
+    case variant::BOOLEAN_PREFIX: { // BOOLEAN
+        if (descriptor.size() <= 1 || descriptor[1] == '0' || descriptor[1] == 'F') {
+            return {false};
+        } else {
+            return {true};
+        }
+    }
+
+    case variant::TEXT_PREFIX: // TEXT
+        return {descriptor.substr(1)};
+
+    case variant::ERROR_PREFIX: // ERROR
+        return {descriptor.substr(1), true};
+
+    case variant::VECTOR2_PREFIX: { // VECTOR2
+        // Format: "2x,y"
+        std::istringstream iss(descriptor);
+        iss.seekg(1);
+        vector2 v{0.0, 0.0};
+        char comma{'Z'};
+        iss >> v.dim[0] >> comma >> v.dim[1];
+        return {v};
+    }
+
+    case variant::VECTOR3_PREFIX: { // VECTOR3
+        // Format: "3x,y,z"
+        std::istringstream iss(descriptor);
+        iss.seekg(1);
+        vector3 v{0.0, 0.0, 0.0};
+        char comma{'Z'};
+        iss >> v.dim[0] >> comma >> v.dim[1] >> comma >> v.dim[2];
+        return {v};
+    }
+
+    case variant::VECTOR4_PREFIX: { // VECTOR4
+        // Format: "4x,y,z,w"
+        std::istringstream iss(descriptor);
+        iss.seekg(1);
+        vector4 v{0.0, 0.0, 0.0, 0.0};
+        char comma{'Z'};
+        iss >> v.dim[0] >> comma >> v.dim[1] >> comma >> v.dim[2] >> comma >> v.dim[3];
+        return {v};
+    }
+
+    case variant::BYTES_PREFIX: { // BYTES
+        // Hex-encoded bytes
+        bytes_t bytes;
+        for (size_t i = 1; i < descriptor.size(); i += 2) {
+            if (i + 1 < descriptor.size()) {
+                text_t hex_byte = descriptor.substr(i, 2);
+                try {
+                    auto byte = static_cast<unsigned char>(std::stoul(hex_byte, nullptr, 16));
+                    bytes.push_back(byte);
+                } catch (...) {
+                    // Skip invalid hex
+                    bytes.push_back(0);
+                }
+            }
+        }
+        return {bytes};
+    }
+
+    case variant::ARRAY_PREFIX: { // ARRAY - special case where '[' is the type indicator
+        // Parse array: [elem1,elem2,elem3]
+        if (descriptor.back() != variant::ARRAY_SUFFIX) {
+            return {std::vector<variant>()};
+        }
+
+        std::vector<variant> elements;
+        if (descriptor.size() <= 2) {
+            return {elements};
+        }
+
+        // Parse comma-separated elements with escape handling
+        size_t start = 1;
+        int bracket_level = 0;
+        int brace_level = 0;
+        bool escaped = false;
+
+        for (size_t i = start; i <= descriptor.length() - 1; ++i) {
+            char c = (i < descriptor.length() - 1) ? descriptor[i] : variant::ARRAY_SEPARATOR; // Treat end as comma
+
+            if (escaped) {
+                escaped = false;
+                continue;
+            }
+
+            if (c == variant::ESCAPE_CHAR) {
+                escaped = true;
+                continue;
+            }
+
+            if (c == variant::ARRAY_PREFIX) {
+                bracket_level++;
+            } else if (c == variant::ARRAY_SUFFIX) {
+                bracket_level--;
+            } else if (c == variant::DICTIONARY_PREFIX) {
+                brace_level++;
+            } else if (c == variant::DICTIONARY_SUFFIX) {
+                brace_level--;
+            } else if (c == variant::ARRAY_SEPARATOR && bracket_level == 0 && brace_level == 0) {
+                // Found a separator at top level
+                text_t element_desc = descriptor.substr(start, i - start);
+
+                text_t unescaped;
+                if (element_desc.size() >= 1 && (element_desc[0] == variant::TEXT_PREFIX || element_desc[0] == variant::ERROR_PREFIX)) {
+                    // Unescape the element descriptor
+                    bool esc = false;
+                    for (char ch : element_desc) {
+                        if (esc) {
+                            unescaped += ch;
+                            esc = false;
+                        } else if (ch == variant::ESCAPE_CHAR) {
+                            esc = true;
+                        } else {
+                            unescaped += ch;
+                        }
+                    }
+                } else {
+                    unescaped = element_desc;
+                }
+
+                elements.push_back(legacy_from_desc(unescaped));
+                start = i + 1;
+            }
+        }
+
+        return {elements};
+    }
+
+    case variant::DICTIONARY_PREFIX: { // DICTIONARY - special case where '{' is the type indicator
+        // Parse dictionary: {key1:value1,key2:value2}
+        if (descriptor.back() != variant::DICTIONARY_SUFFIX) {
+            return {std::map<variant, variant>()};
+        }
+
+        std::map<variant, variant> dict;
+        if (descriptor.size() <= 2) {
+            return {dict};
+        }
+
+        // Parse comma-separated key:value pairs with escape handling
+        size_t start = 1;
+        int bracket_level = 0;
+        int brace_level = 0;
+        bool escaped = false;
+
+        for (size_t i = start; i <= descriptor.length() - 1; ++i) {
+            char c = (i < descriptor.length() - 1) ? descriptor[i] : variant::DICTIONARY_SEPARATOR; // Treat end as comma
+
+            if (escaped) {
+                escaped = false;
+                continue;
+            }
+
+            if (c == variant::ESCAPE_CHAR) {
+                escaped = true;
+                continue;
+            }
+
+            if (c == variant::ARRAY_PREFIX) {
+                bracket_level++;
+            } else if (c == variant::ARRAY_SUFFIX) {
+                bracket_level--;
+            } else if (c == variant::DICTIONARY_PREFIX) {
+                brace_level++;
+            } else if (c == variant::DICTIONARY_SUFFIX) {
+                brace_level--;
+            } else if (c == variant::DICTIONARY_SEPARATOR && bracket_level == 0 && brace_level == 0) {
+                // Found a separator at top level
+                text_t pair_desc = descriptor.substr(start, i - start);
+
+                // Find the key:value separator at top level
+                size_t colon_pos = text_t::npos;
+                int pair_bracket_level = 0;
+                int pair_brace_level = 0;
+                bool pair_escaped = false;
+                for (size_t j = 0; j < pair_desc.size(); ++j) {
+                    if (pair_escaped) {
+                        pair_escaped = false;
+                        continue;
+                    }
+                    if (pair_desc[j] == variant::ESCAPE_CHAR) {
+                        pair_escaped = true;
+                        continue;
+                    }
+                    if (pair_desc[j] == variant::ARRAY_PREFIX) {
+                        pair_bracket_level++;
+                    } else if (pair_desc[j] == variant::ARRAY_SUFFIX) {
+                        pair_bracket_level--;
+                    } else if (pair_desc[j] == variant::DICTIONARY_PREFIX) {
+                        pair_brace_level++;
+                    } else if (pair_desc[j] == variant::DICTIONARY_SUFFIX) {
+                        pair_brace_level--;
+                    } else if (pair_desc[j] == variant::DICTIONARY_KEY_VALUE_SEPARATOR && pair_bracket_level == 0 && pair_brace_level == 0) {
+                        colon_pos = j;
+                        break;
+                    }
+                }
+
+                if (colon_pos != text_t::npos) {
+                    text_t key_desc = pair_desc.substr(0, colon_pos);
+                    text_t value_desc = pair_desc.substr(colon_pos + 1);
+
+                    // Unescape if needed
+                    auto unescape_if_text = [](const text_t &desc) -> text_t {
+                        if (desc.size() >= 1 && (desc[0] == variant::TEXT_PREFIX || desc[0] == variant::ERROR_PREFIX)) {
+                            text_t unescaped;
+                            bool esc = false;
+                            for (char ch : desc) {
+                                if (esc) {
+                                    unescaped += ch;
+                                    esc = false;
+                                } else if (ch == variant::ESCAPE_CHAR) {
+                                    esc = true;
+                                } else {
+                                    unescaped += ch;
+                                }
+                            }
+                            return unescaped;
+                        }
+                        return desc;
+                    };
+
+                    variant key = legacy_from_desc(unescape_if_text(key_desc));
+                    variant value = legacy_from_desc(unescape_if_text(value_desc));
+                    dict[key] = value;
+                }
+
+                start = i + 1;
+            }
+        }
+
+        return {dict};
+    }
+
+    case variant::HASH_PREFIX: { // HASH
+        try {
+            if (descriptor.size() <= 1) {
+                return {hash_t(0)};
+            }
+
+            if (descriptor[1] == ':') {
+                hash_t hash = algorithm_helper::calc_hash(descriptor.substr(2));
+                return {hash};
+            }
+
+            hash_t hash = std::stoull(descriptor.substr(1), nullptr, 16);
+            return {hash};
+        } catch (...) {
+            return {hash_t(0)};
+        }
+    }
+
+    default:
+        return {}; // Unknown type, return VOID
+    }
+}
+
+// The previous recursive concatenating writer, kept as a baseline.
+text_t legacy_to_desc(const variant &v) {
+    switch (v.get_value_type()) {
+    case variant::VOID:
+        return text_t{variant::VOID_PREFIX};
+
+    case variant::INTEGER: {
+        integer_t value = static_cast<integer_t>(v);
+        return std::format("{}{}{}", variant::INTEGER_PREFIX, value, variant::INTEGER_DECIMAL_SUFFIX);
+    }
+
+    case variant::NUMBER: {
+        number_t value = static_cast<number_t>(v);
+        return std::format("{}{}", variant::NUMBER_PREFIX, value);
+    }
+
+    case variant::BOOLEAN: {
+        boolean_t value = static_cast<boolean_t>(v);
+        return std::format("{}{}", variant::BOOLEAN_PREFIX, value ? "1" : "0");
+    }
+
+    case variant::TEXT: {
+        const auto &value = v.get_text();
+        return std::format("{}{}", variant::TEXT_PREFIX, value);
+    }
+
+    case variant::ERROR: {
+        const auto &value = v.get_text();
+        return std::format("{}{}", variant::ERROR_PREFIX, value);
+    }
+
+    case variant::VECTOR2: {
+        const auto &vec = v.get_vector2();
+        return std::format("{}{}{}{}", variant::VECTOR2_PREFIX, vec.get_x(), variant::VECTOR_SEPARATOR, vec.get_y());
+    }
+
+    case variant::VECTOR3: {
+        const auto &vec = v.get_vector3();
+        return std::format("{}{}{}{}{}{}", variant::VECTOR3_PREFIX, vec.get_x(), variant::VECTOR_SEPARATOR, vec.get_y(), variant::VECTOR_SEPARATOR, vec.get_z());
+    }
+
+    case variant::VECTOR4: {
+        const auto &vec = v.get_vector4();
+        return std::format("{}{}{}{}{}{}{}{}", variant::VECTOR4_PREFIX, vec.get_x(), variant::VECTOR_SEPARATOR, vec.get_y(), variant::VECTOR_SEPARATOR, vec.get_z(), variant::VECTOR_SEPARATOR,
+                           vec.get_w());
+    }
+
+    case variant::BYTES: {
+        const auto &bytes = v.get_bytes();
+        text_t result;
+        result.reserve((bytes.size() * 2) + 1);
+        result += variant::BYTES_PREFIX;
+        for (unsigned char byte : bytes) {
+            result += std::format("{:02X}", byte);
+        }
+        return result;
+    }
+
+    case variant::ARRAY: {
+        const auto &elements = v.get_array();
+        text_t result{variant::ARRAY_PREFIX};
+
+        for (size_t i = 0; i < elements.size(); ++i) {
+            if (i > 0) {
+                result += variant::ARRAY_SEPARATOR;
+            }
+
+            auto element_desc = legacy_to_desc(elements[i]);
+
+            if (element_desc.size() >= 1 && (element_desc[0] == variant::TEXT_PREFIX || element_desc[0] == variant::ERROR_PREFIX)) {
+                // Escape special characters in the element string descriptor
+                auto escaped = text_t();
+                escaped.reserve(element_desc.size());
+                for (char c : element_desc) {
+                    if (c == variant::ESCAPE_CHAR || c == variant::ARRAY_SEPARATOR || c == variant::ARRAY_PREFIX || c == variant::ARRAY_SUFFIX) {
+                        escaped += variant::ESCAPE_CHAR;
+                    }
+                    escaped += c;
+                }
+                result += escaped;
+            } else {
+                result += element_desc;
+            }
+        }
+
+        result += variant::ARRAY_SUFFIX;
+        return result;
+    }
+
+    case variant::DICTIONARY: {
+        const auto &dict = v.get_dictionary();
+        text_t result{variant::DICTIONARY_PREFIX};
+
+        size_t count = 0;
+        for (const auto &[key, value] : dict) {
+            if (count > 0) {
+                result += variant::DICTIONARY_SEPARATOR;
+            }
+
+            auto key_desc = legacy_to_desc(key);
+            auto value_desc = legacy_to_desc(value);
+
+            // Escape special characters if needed
+            auto escape_if_needed = [](const text_t &desc) -> text_t {
+                if (desc.size() >= 1 && (desc[0] == variant::TEXT_PREFIX || desc[0] == variant::ERROR_PREFIX)) {
+                    text_t escaped;
+                    escaped.reserve(desc.size());
+                    for (char c : desc) {
+                        if (c == variant::ESCAPE_CHAR || c == variant::DICTIONARY_SEPARATOR || c == variant::DICTIONARY_KEY_VALUE_SEPARATOR || c == variant::DICTIONARY_PREFIX ||
+                            c == variant::DICTIONARY_SUFFIX || c == variant::ARRAY_PREFIX || c == variant::ARRAY_SUFFIX) {
+                            escaped += variant::ESCAPE_CHAR;
+                        }
+                        escaped += c;
+                    }
+                    return escaped;
+                }
+                return desc;
+            };
+
+            result += escape_if_needed(key_desc);
+            result += variant::DICTIONARY_KEY_VALUE_SEPARATOR;
+            result += escape_if_needed(value_desc);
+
+            count++;
+        }
+
+        result += variant::DICTIONARY_SUFFIX;
+        return result;
+    }
+
+    case variant::HASH: {
+        auto hash = static_cast<hash_t>(v);
+        return std::format("{}{:016X}", variant::HASH_PREFIX, hash);
+    }
+
+    default:
+        return text_t{variant::VOID_PREFIX}; // Fallback to VOID
+    }
+}
+
+// A stage-dump-like descriptor: an array of dictionaries holding vectors, texts, numbers and nested arrays.
+variant make_payload(size_t count) {
+    std::vector<variant> entries;
+    entries.reserve(count);
+    for (size_t i = 0; i < count; i++) {
+        std::map<variant, variant> entry;
+        entry[variant("position")] = variant(vector3(static_cast<number_t>(i), 2.5F, -1.25F));
+        entry[variant("name")] = variant(std::format("actor, #{} [main]", i));
+        entry[variant("alpha")] = variant(0.75F);
+        entry[variant("tags")] = variant(std::vector<variant>{variant(static_cast<integer_t>(i)), variant(true), variant(bytes_t{0xDE, 0xAD})});
+        entries.emplace_back(std::move(entry));
+    }
+    return {std::move(entries)};
+}
+
+text_t make_descriptor(size_t count) { return make_payload(count).to_desc(); }
+
+void bm_from_desc(benchmark::State &state) {
+    const auto descriptor = make_descriptor(state.range(0));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(variant::from_desc(descriptor));
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * descriptor.size()));
+}
+
+void bm_legacy_from_desc(benchmark::State &state) {
+    const auto descriptor = make_descriptor(state.range(0));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(legacy_from_desc(descriptor));
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * descriptor.size()));
+}
+
+void bm_to_desc(benchmark::State &state) {
+    const auto payload = make_payload(state.range(0));
+    text_t out;
+    for (auto _ : state) {
+        out.clear();
+        payload.to_desc(out);
+        benchmark::DoNotOptimize(out);
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * out.size()));
+}
+
+void bm_legacy_to_desc(benchmark::State &state) {
+    const auto payload = make_payload(state.range(0));
+    size_t size = 0;
+    for (auto _ : state) {
+        auto out = legacy_to_desc(payload);
+        size = out.size();
+        benchmark::DoNotOptimize(out);
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * size));
+}
+
+} // namespace
+
+BENCHMARK(bm_from_desc)->Arg(16)->Arg(1024);
+BENCHMARK(bm_legacy_from_desc)->Arg(16)->Arg(1024);
+BENCHMARK(bm_to_desc)->Arg(16)->Arg(1024);
+BENCHMARK(bm_legacy_to_desc)->Arg(16)->Arg(1024);
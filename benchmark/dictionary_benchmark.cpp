@@ -0,0 +1,119 @@
+#include "variant.h"
+#include <algorithm>
+#include <benchmark/benchmark.h>
+#include <format>
+#include <map>
+#include <random>
+#include <vector>
+
+using namespace camellia;
+
+namespace {
+
+// Keys in the shuffled order a Lua table traversal would produce them.
+std::vector<variant> make_keys(size_t count) {
+    std::vector<variant> keys;
+    keys.reserve(count);
+    for (size_t i = 0; i < count; i++) {
+        keys.emplace_back(std::format("key_{}", i));
+    }
+    std::shuffle(keys.begin(), keys.end(), std::mt19937(count));
+    return keys;
+}
+
+void bm_dictionary_build_map(benchmark::State &state) {
+    const auto keys = make_keys(state.range(0));
+    for (auto _ : state) {
+        std::map<variant, variant> dict;
+        for (const auto &key : keys) {
+            dict[key] = variant(1);
+        }
+        benchmark::DoNotOptimize(dict);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+void bm_dictionary_build_flat(benchmark::State &state) {
+    const auto keys = make_keys(state.range(0));
+    for (auto _ : state) {
+        variant_dictionary::container_type pairs;
+        pairs.reserve(keys.size());
+        for (const auto &key : keys) {
+            pairs.emplace_back(key, variant(1));
+        }
+        variant_dictionary dict(std::move(pairs));
+        benchmark::DoNotOptimize(dict);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+void bm_dictionary_lookup_map(benchmark::State &state) {
+    const auto keys = make_keys(state.range(0));
+    std::map<variant, variant> dict;
+    for (const auto &key : keys) {
+        dict[key] = variant(1);
+    }
+
+    for (auto _ : state) {
+        for (const auto &key : keys) {
+            benchmark::DoNotOptimize(dict.find(key));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+void bm_dictionary_lookup_flat(benchmark::State &state) {
+    const auto keys = make_keys(state.range(0));
+    variant_dictionary dict;
+    for (const auto &key : keys) {
+        dict[key] = variant(1);
+    }
+
+    for (auto _ : state) {
+        for (const auto &key : keys) {
+            benchmark::DoNotOptimize(dict.find(key));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+void bm_dictionary_iterate_map(benchmark::State &state) {
+    std::map<variant, variant> dict;
+    for (const auto &key : make_keys(state.range(0))) {
+        dict[key] = variant(1);
+    }
+
+    for (auto _ : state) {
+        integer_t sum = 0;
+        for (const auto &[key, value] : dict) {
+            sum += static_cast<integer_t>(value);
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+void bm_dictionary_iterate_flat(benchmark::State &state) {
+    variant_dictionary dict;
+    for (const auto &key : make_keys(state.range(0))) {
+        dict[key] = variant(1);
+    }
+
+    for (auto _ : state) {
+        integer_t sum = 0;
+        for (const auto &[key, value] : dict) {
+            sum += static_cast<integer_t>(value);
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+} // namespace
+
+BENCHMARK(bm_dictionary_build_map)->Arg(4)->Arg(64)->Arg(4096);
+BENCHMARK(bm_dictionary_build_flat)->Arg(4)->Arg(64)->Arg(4096);
+BENCHMARK(bm_dictionary_lookup_map)->Arg(4)->Arg(64)->Arg(4096);
+BENCHMARK(bm_dictionary_lookup_flat)->Arg(4)->Arg(64)->Arg(4096);
+BENCHMARK(bm_dictionary_iterate_map)->Arg(4)->Arg(64)->Arg(4096);
+BENCHMARK(bm_dictionary_iterate_flat)->Arg(4)->Arg(64)->Arg(4096);
@@ -0,0 +1,198 @@
+#include "manager.h"
+#include "message.h"
+#include "message_generated.h"
+#include "spsc_ring.h"
+#include <atomic>
+#include <benchmark/benchmark.h>
+#include <flatbuffers/flatbuffers.h>
+#include <memory>
+#include <memory_resource>
+#include <thread>
+#include <vector>
+
+using namespace camellia;
+
+namespace {
+
+constexpr size_t EVENTS_PER_ITERATION = 4096;
+
+// Baseline: the producer fills the vector, then the same thread drains and clears it.
+void bm_event_vector(benchmark::State &state) {
+    std::vector<std::shared_ptr<event>> queue;
+    const auto p_event = std::make_shared<log_event>("benchmark", log_level::LOG_INFO);
+    size_t consumed = 0;
+    for (auto _ : state) {
+        for (size_t i = 0; i < EVENTS_PER_ITERATION; i++) {
+            queue.push_back(p_event);
+        }
+        for (const auto &e : queue) {
+            consumed += e != nullptr ? 1 : 0;
+        }
+        queue.clear();
+    }
+    benchmark::DoNotOptimize(consumed);
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * EVENTS_PER_ITERATION));
+}
+
+// The benchmark thread produces into the ring while a second thread drains it concurrently.
+void bm_event_ring(benchmark::State &state) {
+    spsc_ring<std::shared_ptr<event>> ring(static_cast<size_t>(state.range(0)));
+    const auto p_event = std::make_shared<log_event>("benchmark", log_level::LOG_INFO);
+    std::atomic<bool> is_running{true};
+    std::atomic<size_t> consumed{0};
+    std::thread consumer([&] {
+        while (is_running.load(std::memory_order_relaxed) || ring.get_size() > 0) {
+            const auto count = ring.drain([](std::shared_ptr<event> &&e) { benchmark::DoNotOptimize(e); });
+            consumed.fetch_add(count, std::memory_order_relaxed);
+        }
+    });
+
+    size_t full_count = 0;
+    for (auto _ : state) {
+        for (size_t i = 0; i < EVENTS_PER_ITERATION; i++) {
+            auto e = p_event;
+            while (!ring.try_push(std::move(e))) {
+                full_count++;
+            }
+        }
+    }
+    is_running.store(false, std::memory_order_relaxed);
+    consumer.join();
+
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * EVENTS_PER_ITERATION));
+    state.counters["full_per_event"] = static_cast<double>(full_count) / static_cast<double>(state.iterations() * EVENTS_PER_ITERATION);
+}
+
+// Through manager::enqueue_event, so overflow handling and statistics are included.
+void bm_manager_event_ring(benchmark::State &state) {
+    manager mgr("benchmark");
+    mgr.enable_event_ring(static_cast<size_t>(state.range(0)));
+    auto *p_ring = mgr.get_event_ring();
+    const auto p_event = std::make_shared<log_event>("benchmark", log_level::LOG_INFO);
+    std::atomic<bool> is_running{true};
+    std::thread consumer([&] {
+        while (is_running.load(std::memory_order_relaxed)) {
+            p_ring->drain([](std::shared_ptr<event> &&e) { benchmark::DoNotOptimize(e); });
+        }
+    });
+
+    for (auto _ : state) {
+        for (size_t i = 0; i < EVENTS_PER_ITERATION; i++) {
+            mgr.enqueue_event(p_event);
+        }
+        mgr.flush_event_overflow();
+    }
+    while (!mgr.flush_event_overflow()) {
+    }
+    is_running.store(false, std::memory_order_relaxed);
+    consumer.join();
+
+    const auto statistics = mgr.get_event_ring_statistics();
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * EVENTS_PER_ITERATION));
+    state.counters["full_per_event"] = static_cast<double>(statistics.full_count) / static_cast<double>(state.iterations() * EVENTS_PER_ITERATION);
+    state.counters["overflow_peak"] = static_cast<double>(statistics.overflow_peak);
+}
+
+// Passes allocations through to the heap and counts them.
+class counting_resource final : public std::pmr::memory_resource {
+public:
+    size_t allocations{0};
+
+private:
+    void *do_allocate(size_t bytes, size_t alignment) override {
+        allocations++;
+        return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+    }
+    void do_deallocate(void *p, size_t bytes, size_t alignment) override { std::pmr::new_delete_resource()->deallocate(p, bytes, alignment); }
+    [[nodiscard]] bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override { return this == &other; }
+};
+
+// Baseline: one make_shared per event, freed when the queue is cleared.
+void bm_event_make_shared(benchmark::State &state) {
+    std::vector<std::shared_ptr<event>> queue;
+    for (auto _ : state) {
+        for (size_t i = 0; i < EVENTS_PER_ITERATION; i++) {
+            queue.push_back(std::make_shared<log_event>("benchmark", LOG_INFO));
+        }
+        queue.clear();
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * EVENTS_PER_ITERATION));
+}
+
+// The same events from a pool like the manager's; heap_allocs_per_event drops to zero once the pool has warmed up.
+void bm_event_pooled(benchmark::State &state) {
+    counting_resource upstream;
+    const std::shared_ptr<std::pmr::memory_resource> p_pool = std::make_shared<std::pmr::synchronized_pool_resource>(&upstream);
+    std::vector<std::shared_ptr<event>> queue;
+    for (auto _ : state) {
+        for (size_t i = 0; i < EVENTS_PER_ITERATION; i++) {
+            queue.push_back(std::allocate_shared<log_event>(shared_resource_allocator<log_event>(p_pool), "benchmark", LOG_INFO));
+        }
+        queue.clear();
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * EVENTS_PER_ITERATION));
+    state.counters["heap_allocs_per_event"] = static_cast<double>(upstream.allocations) / static_cast<double>(state.iterations() * EVENTS_PER_ITERATION);
+}
+
+void bm_manager_enqueue(benchmark::State &state) {
+    manager mgr("benchmark");
+    for (auto _ : state) {
+        for (size_t i = 0; i < EVENTS_PER_ITERATION; i++) {
+            mgr.enqueue_event<log_event>("benchmark", LOG_INFO);
+        }
+        mgr.clear_event_queue();
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * EVENTS_PER_ITERATION));
+}
+
+constexpr size_t EVENTS_PER_FLUSH = 256;
+
+void enqueue_sample_events(manager &mgr) {
+    for (size_t i = 0; i < EVENTS_PER_FLUSH; i++) {
+        mgr.enqueue_event<log_event>("benchmark", LOG_INFO);
+    }
+}
+
+// Baseline: every event finished as its own Event root.
+void bm_encode_events_single(benchmark::State &state) {
+    manager mgr("benchmark");
+    flatbuffers::FlatBufferBuilder builder;
+    size_t bytes = 0;
+    for (auto _ : state) {
+        enqueue_sample_events(mgr);
+        for (const auto &e : mgr.get_event_queue()) {
+            builder.Clear();
+            const auto data = e->to_flatbuffers(builder);
+            builder.Finish(fb::CreateEvent(builder, static_cast<fb::EventData>(e->get_flatbuffers_type()), data));
+            bytes += builder.GetSize();
+        }
+        mgr.clear_event_queue();
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * EVENTS_PER_FLUSH));
+    state.counters["bytes_per_event"] = static_cast<double>(bytes) / static_cast<double>(state.iterations() * EVENTS_PER_FLUSH);
+}
+
+void bm_encode_events_batch(benchmark::State &state) {
+    manager mgr("benchmark");
+    flatbuffers::FlatBufferBuilder builder;
+    size_t bytes = 0;
+    for (auto _ : state) {
+        enqueue_sample_events(mgr);
+        builder.Clear();
+        mgr.flush_events(builder);
+        bytes += builder.GetSize();
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * EVENTS_PER_FLUSH));
+    state.counters["bytes_per_event"] = static_cast<double>(bytes) / static_cast<double>(state.iterations() * EVENTS_PER_FLUSH);
+}
+
+} // namespace
+
+BENCHMARK(bm_encode_events_single);
+BENCHMARK(bm_encode_events_batch);
+BENCHMARK(bm_event_make_shared);
+BENCHMARK(bm_event_pooled);
+BENCHMARK(bm_manager_enqueue);
+BENCHMARK(bm_event_vector);
+BENCHMARK(bm_event_ring)->Arg(256)->Arg(4096)->UseRealTime();
+BENCHMARK(bm_manager_event_ring)->Arg(256)->Arg(4096)->UseRealTime();
@@ -0,0 +1,104 @@
+#include "frame_arena.h"
+#include "variant.h"
+#include <atomic>
+#include <benchmark/benchmark.h>
+#include <cstdlib>
+#include <map>
+#include <new>
+#include <memory_resource>
+#include <utility>
+#include <vector>
+
+using namespace camellia;
+
+// Every heap allocation in the process, so the counters below include variant payloads and not only container nodes
+std::atomic<size_t> heap_allocations{0};
+
+void *operator new(size_t bytes) {
+    heap_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (auto *p = std::malloc(bytes == 0 ? 1 : bytes)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void *operator new(size_t bytes, std::align_val_t alignment) {
+    heap_allocations.fetch_add(1, std::memory_order_relaxed);
+    const auto align = static_cast<size_t>(alignment);
+    if (auto *p = std::aligned_alloc(align, (bytes + align - 1) / align * align)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void *p) noexcept { std::free(p); }
+void operator delete(void *p, size_t /*bytes*/) noexcept { std::free(p); }
+void operator delete(void *p, std::align_val_t /*alignment*/) noexcept { std::free(p); }
+void operator delete(void *p, size_t /*bytes*/, std::align_val_t /*alignment*/) noexcept { std::free(p); }
+
+namespace {
+
+std::map<hash_t, variant> make_initial_attributes(size_t count) {
+    std::map<hash_t, variant> attributes;
+    for (size_t i = 0; i < count; i++) {
+        attributes.emplace(static_cast<hash_t>(i), variant(vector3(static_cast<number_t>(i), 0.0F, 0.0F)));
+    }
+    return attributes;
+}
+
+// One frame shaped like scene::update: every activity layers its initial attributes, runs a timeline that modifies
+// a few of them, then pushes the layer for its child actors. One of the writes is a text longer than the SSO buffer,
+// whose payload goes to the heap in both variants.
+void simulate_frame(std::pmr::memory_resource *p_resource, const std::vector<std::map<hash_t, variant>> &initial, number_t time) {
+    frame_attribute_stack parent_attributes(p_resource);
+    for (const auto &attributes : initial) {
+        frame_attribute_layer layer(attributes, p_resource);
+        for (hash_t h_key = 0; h_key < 4; h_key++) {
+            layer.set(h_key, variant(vector3(time, time, time)));
+        }
+        layer.set(4, variant(text_t("a caption that is too long for the small string buffer")));
+        parent_attributes.push_back(std::move(layer));
+        benchmark::DoNotOptimize(parent_attributes.back().find(0));
+        parent_attributes.pop_back();
+    }
+}
+
+void bm_frame_heap(benchmark::State &state) {
+    const std::vector<std::map<hash_t, variant>> initial(static_cast<size_t>(state.range(0)), make_initial_attributes(16));
+    number_t time = 0.0F;
+    size_t allocations = 0;
+    for (auto _ : state) {
+        const auto before = heap_allocations.load(std::memory_order_relaxed);
+        simulate_frame(std::pmr::new_delete_resource(), initial, time += 0.016F);
+        allocations += heap_allocations.load(std::memory_order_relaxed) - before;
+    }
+    state.counters["heap_allocs_per_frame"] = static_cast<double>(allocations) / static_cast<double>(state.iterations());
+}
+
+void bm_frame_arena(benchmark::State &state) {
+    const std::vector<std::map<hash_t, variant>> initial(static_cast<size_t>(state.range(0)), make_initial_attributes(16));
+    frame_arena arena;
+    number_t time = 0.0F;
+
+    // Let the arena settle on its steady-state capacity before measuring
+    simulate_frame(&arena, initial, time);
+    arena.reset();
+
+    size_t allocations = 0;
+    size_t arena_allocations = 0;
+    for (auto _ : state) {
+        arena.reset();
+        const auto before = heap_allocations.load(std::memory_order_relaxed);
+        simulate_frame(&arena, initial, time += 0.016F);
+        allocations += heap_allocations.load(std::memory_order_relaxed) - before;
+        arena_allocations += arena.get_allocation_count();
+    }
+    // What is left on the heap here is the text payloads; variant payloads do not come from the arena
+    state.counters["heap_allocs_per_frame"] = static_cast<double>(allocations) / static_cast<double>(state.iterations());
+    state.counters["arena_allocs_per_frame"] = static_cast<double>(arena_allocations) / static_cast<double>(state.iterations());
+}
+
+} // namespace
+
+BENCHMARK(bm_frame_heap)->Arg(8)->Arg(64);
+BENCHMARK(bm_frame_arena)->Arg(8)->Arg(64);
@@ -0,0 +1,151 @@
+#include "helper/algorithm_helper.h"
+#include "variant.h"
+#include <benchmark/benchmark.h>
+#include <map>
+#include <variant>
+#include <vector>
+
+using namespace camellia;
+
+namespace {
+
+// The previous variant layout (an explicit tag next to a std::variant), kept as a baseline.
+class legacy_variant {
+public:
+    using storage = std::variant<std::monostate, integer_t, number_t, boolean_t, text_t, vector2, vector3, vector4, bytes_t, std::vector<legacy_variant>,
+                                 std::map<legacy_variant, legacy_variant>, hash_t>;
+
+    legacy_variant() : _type(variant::VOID) {}
+    explicit(false) legacy_variant(number_t n) : _type(variant::NUMBER), _data(n) {}
+    explicit(false) legacy_variant(const text_t &t) : _type(variant::TEXT), _data(t) {}
+    explicit(false) legacy_variant(const vector3 &v) : _type(variant::VECTOR3), _data(v) {}
+
+    bool operator==(const legacy_variant &other) const {
+        if (_type != other._type) {
+            return false;
+        }
+        switch (_type) {
+        case variant::NUMBER:
+            return std::get<number_t>(_data) == std::get<number_t>(other._data);
+        case variant::TEXT:
+            return std::get<text_t>(_data) == std::get<text_t>(other._data);
+        case variant::VECTOR3:
+            return std::get<vector3>(_data) == std::get<vector3>(other._data);
+        default:
+            return _data == other._data;
+        }
+    }
+
+    [[nodiscard]] bool approx_equals(const legacy_variant &other) const {
+        switch (_type) {
+        case variant::NUMBER:
+            return other._type == variant::NUMBER && algorithm_helper::approx_equals(std::get<number_t>(_data), std::get<number_t>(other._data));
+        case variant::VECTOR3:
+            return other._type == variant::VECTOR3 && std::get<vector3>(_data).approx_equals(std::get<vector3>(other._data));
+        default:
+            return *this == other;
+        }
+    }
+
+private:
+    variant::types _type;
+    storage _data;
+};
+
+template <typename V> V make_attribute(size_t i) {
+    switch (i % 3) {
+    case 0:
+        return V(vector3(static_cast<number_t>(i), 1.0F, 2.0F));
+    case 1:
+        return V(static_cast<number_t>(i) * 0.5F);
+    default:
+        return V(text_t("attribute value that does not fit into SSO"));
+    }
+}
+
+template <typename V> void bm_layout_size(benchmark::State &state) {
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(sizeof(V));
+    }
+    state.counters["bytes"] = static_cast<double>(sizeof(V));
+}
+
+template <typename V> void bm_copy_vector3(benchmark::State &state) {
+    const V src(vector3(1.0F, 2.0F, 3.0F));
+    for (auto _ : state) {
+        V dst(src);
+        benchmark::DoNotOptimize(dst);
+    }
+}
+
+template <typename V> void bm_copy_text(benchmark::State &state) {
+    const V src(text_t("attribute value that does not fit into SSO"));
+    for (auto _ : state) {
+        V dst(src);
+        benchmark::DoNotOptimize(dst);
+    }
+}
+
+template <typename V> void bm_equals_vector3(benchmark::State &state) {
+    const V a(vector3(1.0F, 2.0F, 3.0F));
+    const V b(vector3(1.0F, 2.0F, 3.0F));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(a == b);
+    }
+}
+
+template <typename V> void bm_approx_equals_vector3(benchmark::State &state) {
+    const V a(vector3(1.0F, 2.0F, 3.0F));
+    const V b(vector3(1.0F, 2.0F, 3.000001F));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(a.approx_equals(b));
+    }
+}
+
+// Mirrors the per-frame attribute map copy in action_timeline::update.
+template <typename V> void bm_attribute_map_copy(benchmark::State &state) {
+    std::map<hash_t, V> attributes;
+    for (size_t i = 0; i < static_cast<size_t>(state.range(0)); i++) {
+        attributes.emplace(static_cast<hash_t>(i), make_attribute<V>(i));
+    }
+
+    for (auto _ : state) {
+        std::map<hash_t, V> temp_attributes{attributes};
+        benchmark::DoNotOptimize(temp_attributes);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+void bm_hash_bytes(benchmark::State &state) {
+    const variant v(bytes_t(static_cast<size_t>(state.range(0)), 0x5AU));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(std::hash<variant>{}(v));
+    }
+    state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+
+// A shared payload reuses its cached hash after the first call
+void bm_hash_shared_bytes(benchmark::State &state) {
+    const variant v(bytes_t(static_cast<size_t>(state.range(0)), 0x5AU));
+    const variant shared(v);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(std::hash<variant>{}(shared));
+    }
+}
+
+} // namespace
+
+BENCHMARK(bm_layout_size<variant>);
+BENCHMARK(bm_layout_size<legacy_variant>);
+BENCHMARK(bm_copy_vector3<variant>);
+BENCHMARK(bm_copy_vector3<legacy_variant>);
+BENCHMARK(bm_copy_text<variant>);
+BENCHMARK(bm_copy_text<legacy_variant>);
+BENCHMARK(bm_equals_vector3<variant>);
+BENCHMARK(bm_equals_vector3<legacy_variant>);
+BENCHMARK(bm_approx_equals_vector3<variant>);
+BENCHMARK(bm_approx_equals_vector3<legacy_variant>);
+BENCHMARK(bm_attribute_map_copy<variant>)->Arg(16)->Arg(256);
+BENCHMARK(bm_attribute_map_copy<legacy_variant>)->Arg(16)->Arg(256);
+BENCHMARK(bm_hash_bytes)->Arg(1024)->Arg(1 << 20);
+BENCHMARK(bm_hash_shared_bytes)->Arg(1 << 20);
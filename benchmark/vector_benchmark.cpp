@@ -0,0 +1,102 @@
+#include "helper/algorithm_helper.h"
+#include "variant.h"
+#include <benchmark/benchmark.h>
+#include <memory>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+using namespace camellia;
+
+namespace {
+
+// The per-component loop vectorX::approx_equals used before the lane kernels, kept as a baseline.
+template <typename T> bool scalar_approx_equals(const T &a, const T &b) {
+    for (size_t i = 0; i < a.dim.size(); i++) {
+        if (!algorithm_helper::approx_equals(a.dim[i], b.dim[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Old/new attribute pairs where roughly every fourth one actually moved.
+template <typename T> void make_pairs(size_t count, std::vector<T> &old_values, std::vector<T> &new_values) {
+    old_values.clear();
+    new_values.clear();
+    for (size_t i = 0; i < count; i++) {
+        auto base = static_cast<number_t>(i * 7) * 0.25F;
+        T v = [&] {
+            if constexpr (std::is_same_v<T, vector2>) {
+                return T(base, base + 0.25F);
+            } else if constexpr (std::is_same_v<T, vector3>) {
+                return T(base, base + 0.25F, base + 0.5F);
+            } else {
+                return T(base, base + 0.25F, base + 0.5F, base + 0.75F);
+            }
+        }();
+        old_values.push_back(v);
+        if (i % 4 == 0) {
+            v.dim[0] += 1.0F;
+        }
+        new_values.push_back(v);
+    }
+}
+
+template <typename T> void bm_scalar_loop(benchmark::State &state) {
+    std::vector<T> old_values;
+    std::vector<T> new_values;
+    make_pairs(static_cast<size_t>(state.range(0)), old_values, new_values);
+    auto out = std::make_unique<boolean_t[]>(old_values.size());
+
+    for (auto _ : state) {
+        for (size_t i = 0; i < old_values.size(); i++) {
+            out[i] = scalar_approx_equals(old_values[i], new_values[i]);
+        }
+        benchmark::DoNotOptimize(out.get());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+template <typename T> void bm_member(benchmark::State &state) {
+    std::vector<T> old_values;
+    std::vector<T> new_values;
+    make_pairs(static_cast<size_t>(state.range(0)), old_values, new_values);
+    auto out = std::make_unique<boolean_t[]>(old_values.size());
+
+    for (auto _ : state) {
+        for (size_t i = 0; i < old_values.size(); i++) {
+            out[i] = old_values[i].approx_equals(new_values[i]);
+        }
+        benchmark::DoNotOptimize(out.get());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+template <typename T> void bm_batch(benchmark::State &state) {
+    std::vector<T> old_values;
+    std::vector<T> new_values;
+    make_pairs(static_cast<size_t>(state.range(0)), old_values, new_values);
+    auto out = std::make_unique<boolean_t[]>(old_values.size());
+
+    for (auto _ : state) {
+        algorithm_helper::approx_equals_batch(std::span<const T>(old_values), std::span<const T>(new_values), std::span(out.get(), old_values.size()));
+        benchmark::DoNotOptimize(out.get());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+} // namespace
+
+BENCHMARK(bm_scalar_loop<vector2>)->Arg(256);
+BENCHMARK(bm_member<vector2>)->Arg(256);
+BENCHMARK(bm_batch<vector2>)->Arg(256);
+BENCHMARK(bm_scalar_loop<vector3>)->Arg(256);
+BENCHMARK(bm_member<vector3>)->Arg(256);
+BENCHMARK(bm_batch<vector3>)->Arg(256);
+BENCHMARK(bm_scalar_loop<vector4>)->Arg(256);
+BENCHMARK(bm_member<vector4>)->Arg(256);
+BENCHMARK(bm_batch<vector4>)->Arg(256);
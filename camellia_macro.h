@@ -8,17 +8,24 @@
 #define RETURN_ZERO_IF_NULL(P) RETURN_IF_NULL(P, 0)
 #define RETURN_FALSE_IF_NULL(P) RETURN_IF_NULL(P, false)
 
-#define WARN_LOG(M)                                                                                                                                            \
+// M is only evaluated when the manager accepts level L, the locator only once the event is serialized
+#define LEVEL_LOG(L, M)                                                                                                                                        \
     do {                                                                                                                                                       \
-        auto warning_msg = get_class_name() + ": " + M + "\n" + get_locator();                                                                                 \
-        get_manager().log(warning_msg, log_level::LOG_WARN);                                                                                                   \
+        if (get_manager().is_log_enabled(L)) {                                                                                                                 \
+            get_manager().log(get_class_name() + ": " + M, L, [this] { return get_locator(); });                                                               \
+        }                                                                                                                                                      \
     } while (0)
 
+#define WARN_LOG(M) LEVEL_LOG(log_level::LOG_WARN, M)
+
+// Failures always build the message since the node keeps it, logging it is still gated by level
 #define FAIL_LOG(M)                                                                                                                                            \
     do {                                                                                                                                                       \
         auto error_msg = get_class_name() + ": " + M + "\n" + get_locator();                                                                                   \
         _set_fail(error_msg);                                                                                                                                  \
-        get_manager().log(error_msg, log_level::LOG_ERROR);                                                                                                    \
+        if (get_manager().is_log_enabled(log_level::LOG_ERROR)) {                                                                                              \
+            get_manager().log(std::move(error_msg), log_level::LOG_ERROR);                                                                                     \
+        }                                                                                                                                                      \
         return;                                                                                                                                                \
     } while (0)
 
@@ -26,7 +33,9 @@
     do {                                                                                                                                                       \
         auto error_msg = get_class_name() + ": " + M + "\n" + get_locator();                                                                                   \
         _set_fail(error_msg);                                                                                                                                  \
-        get_manager().log(error_msg, log_level::LOG_ERROR);                                                                                                    \
+        if (get_manager().is_log_enabled(log_level::LOG_ERROR)) {                                                                                              \
+            get_manager().log(std::move(error_msg), log_level::LOG_ERROR);                                                                                     \
+        }                                                                                                                                                      \
         return R;                                                                                                                                              \
     } while (0)
 
@@ -0,0 +1,62 @@
+#include "frame_arena.h"
+#include <bit>
+
+namespace camellia {
+
+frame_arena::frame_arena(size_t initial_capacity) : _p_buffer(std::make_unique<std::byte[]>(initial_capacity)), _capacity(initial_capacity) {
+    _resource.emplace(_p_buffer.get(), _capacity, std::pmr::new_delete_resource());
+}
+
+void frame_arena::reset() {
+    // Alignment padding is not counted, so grow with some headroom
+    if (_bytes_allocated > _capacity) {
+        _spill_count++;
+        _resource.reset();
+        _capacity = std::bit_ceil(_bytes_allocated + _bytes_allocated / 4);
+        _p_buffer = std::make_unique<std::byte[]>(_capacity);
+    }
+
+    _resource.emplace(_p_buffer.get(), _capacity, std::pmr::new_delete_resource());
+    _allocation_count = 0;
+    _bytes_allocated = 0;
+}
+
+void *frame_arena::do_allocate(size_t bytes, size_t alignment) {
+    _allocation_count++;
+    _bytes_allocated += bytes;
+    return _resource->allocate(bytes, alignment);
+}
+
+const variant *frame_attribute_layer::find(hash_t h_key) const {
+    if (_p_layout != nullptr) {
+        if (const auto slot = _p_layout->find_slot(h_key); slot != attribute_layout::INVALID_SLOT) {
+            return find_at(slot);
+        }
+    }
+    if (const auto it = _overrides.find(h_key); it != _overrides.end()) {
+        return &it->second;
+    }
+    if (const auto it = _p_base->find(h_key); it != _p_base->end()) {
+        return &it->second;
+    }
+    return nullptr;
+}
+
+void frame_attribute_layer::set(hash_t h_key, variant &&value) {
+    if (_p_layout != nullptr) {
+        if (const auto slot = _p_layout->find_slot(h_key); slot != attribute_layout::INVALID_SLOT) {
+            set_at(slot, std::move(value));
+            return;
+        }
+    }
+    _overrides.insert_or_assign(h_key, std::move(value));
+}
+
+void frame_attribute_layer::set_at(slot_t slot, variant &&value) {
+    if (_slot_overrides.empty()) {
+        _slot_overrides.resize(_p_layout->get_size());
+    }
+    _slot_overrides[slot] = std::move(value);
+}
+
+} // namespace camellia
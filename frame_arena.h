@@ -0,0 +1,157 @@
+#ifndef CAMELLIA_FRAME_ARENA_H
+#define CAMELLIA_FRAME_ARENA_H
+
+#include "attribute_layout.h"
+#include "camellia_typedef.h"
+#include "variant.h"
+#include <map>
+#include <memory>
+#include <memory_resource>
+#include <optional>
+#include <span>
+#include <utility>
+#include <vector>
+
+namespace camellia {
+
+// Monotonic memory for containers that live no longer than one stage::update. Deallocation is a no-op; reset()
+// drops everything at once. A frame that spills past the buffer grows it, so steady-state frames never reach the heap.
+// Variant payloads (text, bytes, arrays, dictionaries) stay on the heap: values written during a frame are moved
+// into attribute registries and events that outlive reset().
+class frame_arena final : public std::pmr::memory_resource {
+public:
+    static constexpr size_t DEFAULT_CAPACITY = 64ULL * 1024ULL;
+
+    explicit frame_arena(size_t initial_capacity = DEFAULT_CAPACITY);
+    ~frame_arena() override = default;
+    frame_arena(const frame_arena &) = delete;
+    frame_arena &operator=(const frame_arena &) = delete;
+    frame_arena(frame_arena &&) = delete;
+    frame_arena &operator=(frame_arena &&) = delete;
+
+    // Invalidates everything allocated since the previous reset
+    void reset();
+
+    // Counters for the current frame
+    [[nodiscard]] size_t get_allocation_count() const noexcept { return _allocation_count; }
+    [[nodiscard]] size_t get_bytes_allocated() const noexcept { return _bytes_allocated; }
+    [[nodiscard]] size_t get_capacity() const noexcept { return _capacity; }
+    // Frames so far that had to fall back to the heap
+    [[nodiscard]] size_t get_spill_count() const noexcept { return _spill_count; }
+
+private:
+    void *do_allocate(size_t bytes, size_t alignment) override;
+    void do_deallocate(void * /*p*/, size_t /*bytes*/, size_t /*alignment*/) override {}
+    [[nodiscard]] bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override { return this == &other; }
+
+    std::unique_ptr<std::byte[]> _p_buffer;
+    size_t _capacity;
+    std::optional<std::pmr::monotonic_buffer_resource> _resource;
+
+    size_t _allocation_count{0};
+    size_t _bytes_allocated{0};
+    size_t _spill_count{0};
+};
+
+// Attribute maps that are built and thrown away within a frame; they allocate from the manager's frame_arena
+using frame_attribute_map = std::pmr::map<hash_t, variant>;
+
+// One actor's attributes for a frame. The activity's initial values are read in place and only the entries the
+// timeline writes are copied into the arena. The initial values must outlive the layer.
+// With a layout, the layout's keys live in slots: base_slots holds the initial value of every slot (nullptr where
+// there is none) and must outlive the layer too.
+class frame_attribute_layer {
+public:
+    using base_map = std::map<hash_t, variant>;
+    using slot_t = attribute_layout::slot_t;
+
+    frame_attribute_layer(const base_map &base, std::pmr::memory_resource *p_resource) : _p_base(&base), _overrides(p_resource), _slot_overrides(p_resource) {}
+    frame_attribute_layer(const base_map &base, const attribute_layout *p_layout, std::span<const variant *const> base_slots,
+                          std::pmr::memory_resource *p_resource)
+        : _p_base(&base), _p_layout(p_layout), _base_slots(base_slots), _overrides(p_resource), _slot_overrides(p_resource) {}
+
+    // Value written this frame, else the initial value, else nullptr
+    [[nodiscard]] const variant *find(hash_t h_key) const;
+    void set(hash_t h_key, variant &&value);
+
+    [[nodiscard]] const attribute_layout *get_layout() const { return _p_layout; }
+    // Same as find/set for the key in slot of the layout, without a lookup; only valid on a layer with a layout
+    [[nodiscard]] const variant *find_at(slot_t slot) const {
+        return slot < _slot_overrides.size() && _slot_overrides[slot].has_value() ? &*_slot_overrides[slot] : _base_slots[slot];
+    }
+    void set_at(slot_t slot, variant &&value);
+
+    // Visits every key once in ascending order, passing the written value in place of the initial one
+    template <typename F> void for_each(F &&f) const {
+        _for_each(*this, [&f](hash_t h_key, auto &value, slot_t) { f(h_key, value); });
+    }
+    template <typename F> void for_each(F &&f) {
+        _for_each(*this, [&f](hash_t h_key, auto &value, slot_t) { f(h_key, value); });
+    }
+    // Same as for_each, also passing each key's slot in the layout, INVALID_SLOT for keys outside it
+    template <typename F> void for_each_slot(F &&f) const { _for_each(*this, f); }
+    template <typename F> void for_each_slot(F &&f) { _for_each(*this, f); }
+
+private:
+    template <typename L, typename F> static void _for_each(L &layer, F &&f);
+
+    const base_map *_p_base;
+    const attribute_layout *_p_layout{nullptr};
+    std::span<const variant *const> _base_slots;
+    // Keys outside the layout
+    frame_attribute_map _overrides;
+    // Slots written this frame, sized to the layout on the first write
+    std::pmr::vector<std::optional<variant>> _slot_overrides;
+};
+
+template <typename L, typename F> void frame_attribute_layer::_for_each(L &layer, F &&f) {
+    const auto *p_layout = layer._p_layout;
+    const auto layout_size = p_layout != nullptr ? p_layout->get_size() : 0;
+    const auto written_size = layer._slot_overrides.size();
+    slot_t slot = 0;
+    // Layout keys are sorted too, so each key's slot is found by walking the layout alongside. Written slots whose
+    // key has no initial value are visited when the walk passes them.
+    auto visit = [&](hash_t h_key, auto &value) {
+        for (; slot < layout_size && p_layout->get_key(slot) < h_key; slot++) {
+            if (slot < written_size && layer._slot_overrides[slot].has_value()) {
+                f(p_layout->get_key(slot), *layer._slot_overrides[slot], slot);
+            }
+        }
+        if (slot < layout_size && p_layout->get_key(slot) == h_key) {
+            if (slot < written_size && layer._slot_overrides[slot].has_value()) {
+                f(h_key, *layer._slot_overrides[slot], slot);
+            } else {
+                f(h_key, value, slot);
+            }
+            slot++;
+        } else {
+            f(h_key, value, attribute_layout::INVALID_SLOT);
+        }
+    };
+
+    auto base_it = layer._p_base->begin();
+    const auto base_end = layer._p_base->end();
+    for (auto &[h_key, value] : layer._overrides) {
+        for (; base_it != base_end && base_it->first < h_key; ++base_it) {
+            visit(base_it->first, base_it->second);
+        }
+        if (base_it != base_end && base_it->first == h_key) {
+            ++base_it;
+        }
+        visit(h_key, value);
+    }
+    for (; base_it != base_end; ++base_it) {
+        visit(base_it->first, base_it->second);
+    }
+    for (; slot < written_size; slot++) {
+        if (layer._slot_overrides[slot].has_value()) {
+            f(p_layout->get_key(slot), *layer._slot_overrides[slot], slot);
+        }
+    }
+}
+
+using frame_attribute_stack = std::pmr::vector<frame_attribute_layer>;
+
+} // namespace camellia
+
+#endif // CAMELLIA_FRAME_ARENA_H
@@ -1,9 +1,11 @@
 ﻿
 #include "algorithm_helper.h"
 #include "camellia_typedef.h"
+#include "string_interner.h"
 #include "variant.h"
 #include "xxhash.h"
 #include <algorithm>
+#include <array>
 #include <cctype>
 #include <cmath>
 #include <cstring>
@@ -12,12 +14,198 @@
 #include <unordered_map>
 #include <vector>
 
+#if !defined(CAMELLIA_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define CAMELLIA_SIMD_SSE2
+#include <emmintrin.h>
+#elif !defined(CAMELLIA_NO_SIMD) && (defined(__ARM_NEON) || defined(_M_ARM64))
+#define CAMELLIA_SIMD_NEON
+#include <arm_neon.h>
+#endif
+
 namespace camellia::algorithm_helper {
 boolean_t approx_equals(number_t a, number_t b) {
     auto tolerance = std::max({1.0F, std::fabsf(a), std::fabsf(b)});
     return std::fabsf(a - b) <= std::numeric_limits<float>::epsilon() * tolerance;
 }
 
+namespace {
+static_assert(sizeof(vector2) == 2 * sizeof(number_t) && sizeof(vector3) == 3 * sizeof(number_t) && sizeof(vector4) == 4 * sizeof(number_t),
+              "vectors must be tightly packed for the batch kernels");
+
+#if defined(CAMELLIA_SIMD_SSE2)
+using lanes_t = __m128;
+
+lanes_t load_lanes(const number_t *p) { return _mm_loadu_ps(p); }
+
+// Lanes past count are zero in both operands, which always compare equal
+lanes_t load_lanes(const number_t *p, size_t count) {
+    switch (count) {
+    case 1:
+        return _mm_load_ss(p);
+    case 2:
+        return _mm_castpd_ps(_mm_load_sd(reinterpret_cast<const double *>(p)));
+    case 3:
+        return _mm_movelh_ps(_mm_castpd_ps(_mm_load_sd(reinterpret_cast<const double *>(p))), _mm_load_ss(p + 2));
+    default:
+        return _mm_loadu_ps(p);
+    }
+}
+
+// Bit i is set when lane i of a and b is approximately equal
+unsigned int approx_equals_lanes(lanes_t a, lanes_t b) {
+    const auto abs_mask = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+    auto tolerance = _mm_max_ps(_mm_set1_ps(1.0F), _mm_max_ps(_mm_and_ps(a, abs_mask), _mm_and_ps(b, abs_mask)));
+    auto diff = _mm_and_ps(_mm_sub_ps(a, b), abs_mask);
+    return static_cast<unsigned int>(_mm_movemask_ps(_mm_cmple_ps(diff, _mm_mul_ps(_mm_set1_ps(std::numeric_limits<float>::epsilon()), tolerance))));
+}
+#elif defined(CAMELLIA_SIMD_NEON)
+using lanes_t = float32x4_t;
+
+lanes_t load_lanes(const number_t *p) { return vld1q_f32(p); }
+
+lanes_t load_lanes(const number_t *p, size_t count) {
+    auto lanes = vdupq_n_f32(0.0F);
+    switch (count) {
+    case 3:
+        lanes = vld1q_lane_f32(p + 2, lanes, 2);
+        [[fallthrough]];
+    case 2:
+        lanes = vld1q_lane_f32(p + 1, lanes, 1);
+        [[fallthrough]];
+    case 1:
+        return vld1q_lane_f32(p, lanes, 0);
+    default:
+        return vld1q_f32(p);
+    }
+}
+
+unsigned int approx_equals_lanes(lanes_t a, lanes_t b) {
+    auto tolerance = vmaxq_f32(vdupq_n_f32(1.0F), vmaxq_f32(vabsq_f32(a), vabsq_f32(b)));
+    auto ok = vcleq_f32(vabdq_f32(a, b), vmulq_f32(vdupq_n_f32(std::numeric_limits<float>::epsilon()), tolerance));
+    const uint32_t lane_bits[4] = {1U, 2U, 4U, 8U};
+    const auto bits = vandq_u32(ok, vld1q_u32(lane_bits));
+#if defined(__aarch64__) || defined(_M_ARM64)
+    return vaddvq_u32(bits);
+#else
+    // ARMv7 has no across-vector add, fold the halves pairwise instead
+    const auto pairs = vpadd_u32(vget_low_u32(bits), vget_high_u32(bits));
+    return vget_lane_u32(vpadd_u32(pairs, pairs), 0);
+#endif
+}
+#else
+using lanes_t = std::array<number_t, 4>;
+
+lanes_t load_lanes(const number_t *p, size_t count = 4) {
+    lanes_t lanes{};
+    std::copy_n(p, std::min<size_t>(count, 4), lanes.begin());
+    return lanes;
+}
+
+unsigned int approx_equals_lanes(const lanes_t &a, const lanes_t &b) {
+    unsigned int mask = 0;
+    for (int i = 0; i < 4; i++) {
+        mask |= approx_equals(a[i], b[i]) ? 1U << i : 0U;
+    }
+    return mask;
+}
+#endif
+
+unsigned int approx_equals_lanes(const number_t *p_a, const number_t *p_b) { return approx_equals_lanes(load_lanes(p_a), load_lanes(p_b)); }
+
+unsigned int approx_equals_lanes(const number_t *p_a, const number_t *p_b, size_t count) {
+    return approx_equals_lanes(load_lanes(p_a, count), load_lanes(p_b, count));
+}
+
+void check_batch_sizes(size_t a, size_t b, size_t out) {
+    if (a != b || a != out) {
+        throw std::invalid_argument("approx_equals_batch: spans must be the same size");
+    }
+}
+} // namespace
+
+boolean_t approx_equals(const number_t *p_a, const number_t *p_b, size_t count) {
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        if (approx_equals_lanes(p_a + i, p_b + i) != 0xFU) {
+            return false;
+        }
+    }
+    return i == count || approx_equals_lanes(p_a + i, p_b + i, count - i) == 0xFU;
+}
+
+void approx_equals_batch(std::span<const vector2> a, std::span<const vector2> b, std::span<boolean_t> out) {
+    check_batch_sizes(a.size(), b.size(), out.size());
+    // Two vector2 per register
+    size_t i = 0;
+    for (; i + 2 <= a.size(); i += 2) {
+        auto mask = approx_equals_lanes(a[i].dim.data(), b[i].dim.data());
+        out[i] = (mask & 0x3U) == 0x3U;
+        out[i + 1] = (mask & 0xCU) == 0xCU;
+    }
+    if (i < a.size()) {
+        out[i] = approx_equals_lanes(a[i].dim.data(), b[i].dim.data(), 2) == 0xFU;
+    }
+}
+
+void approx_equals_batch(std::span<const vector3> a, std::span<const vector3> b, std::span<boolean_t> out) {
+    check_batch_sizes(a.size(), b.size(), out.size());
+    if (a.empty()) {
+        return;
+    }
+    // Every element but the last can over-read one float into its successor; that lane is masked off
+    auto last = a.size() - 1;
+    for (size_t i = 0; i < last; i++) {
+        out[i] = (approx_equals_lanes(a[i].dim.data(), b[i].dim.data()) & 0x7U) == 0x7U;
+    }
+    out[last] = approx_equals_lanes(a[last].dim.data(), b[last].dim.data(), 3) == 0xFU;
+}
+
+void approx_equals_batch(std::span<const vector4> a, std::span<const vector4> b, std::span<boolean_t> out) {
+    check_batch_sizes(a.size(), b.size(), out.size());
+    for (size_t i = 0; i < a.size(); i++) {
+        out[i] = approx_equals_lanes(a[i].dim.data(), b[i].dim.data()) == 0xFU;
+    }
+}
+
+number_t ease(easing_types type, number_t t) {
+    t = std::clamp(t, 0.0F, 1.0F);
+    switch (type) {
+    case EASE_IN_QUAD:
+        return t * t;
+    case EASE_OUT_QUAD:
+        return t * (2.0F - t);
+    case EASE_IN_OUT_QUAD:
+        return t < 0.5F ? 2.0F * t * t : 1.0F - 2.0F * (1.0F - t) * (1.0F - t);
+    case EASE_IN_CUBIC:
+        return t * t * t;
+    case EASE_OUT_CUBIC: {
+        auto u = 1.0F - t;
+        return 1.0F - u * u * u;
+    }
+    case EASE_IN_OUT_CUBIC: {
+        auto u = 1.0F - t;
+        return t < 0.5F ? 4.0F * t * t * t : 1.0F - 4.0F * u * u * u;
+    }
+    case EASE_SMOOTHSTEP:
+        return t * t * (3.0F - 2.0F * t);
+    default:
+        return t;
+    }
+}
+
+std::optional<easing_types> parse_easing(std::string_view name) {
+    constexpr std::pair<std::string_view, easing_types> NAMES[] = {
+        {"linear", EASE_LINEAR},       {"in_quad", EASE_IN_QUAD},   {"out_quad", EASE_OUT_QUAD},         {"in_out_quad", EASE_IN_OUT_QUAD},
+        {"in_cubic", EASE_IN_CUBIC},   {"out_cubic", EASE_OUT_CUBIC}, {"in_out_cubic", EASE_IN_OUT_CUBIC}, {"smoothstep", EASE_SMOOTHSTEP},
+    };
+    for (const auto &[n, type] : NAMES) {
+        if (n == name) {
+            return type;
+        }
+    }
+    return std::nullopt;
+}
+
 integer_t get_bbcode_string_length(const text_t &bbcode) {
     integer_t res = 0;
     for (int i = 0; i < bbcode.length(); i++) {
@@ -41,7 +229,9 @@ integer_t get_bbcode_string_length(const text_t &bbcode) {
     return res;
 }
 
-hash_t calc_hash(const std::string &str) noexcept {
+hash_t calc_hash(const std::string &str) noexcept { return calc_hash(std::string_view(str)); }
+
+hash_t calc_hash(std::string_view str) noexcept {
     auto hash = XXH3_64bits_withSeed(str.data(), str.size(), XXHASH_SEED);
     if (hash >= RESERVE_SIZE) [[likely]] {
         return hash;
@@ -54,19 +244,7 @@ hash_t calc_hash(const std::string &str) noexcept {
     return hash;
 }
 
-hash_t calc_hash(const char *str) noexcept {
-    auto len = std::strlen(str);
-    auto hash = XXH3_64bits_withSeed(str, len, XXHASH_SEED);
-    if (hash >= RESERVE_SIZE) [[likely]] {
-        return hash;
-    }
-
-    // Jackpot!!!
-    for (auto seed = XXHASH_SEED + 1; hash < RESERVE_SIZE; seed++) {
-        hash = XXH3_64bits_withSeed(str, len, seed);
-    }
-    return hash;
-}
+hash_t calc_hash(const char *str) noexcept { return calc_hash(std::string_view(str)); }
 
 number_t calc_bbcode_node_duration(const bbcode::bbcode_node &node, number_t duration_per_char) {
     switch (node.get_type()) {
@@ -312,36 +490,54 @@ text_t bbcode::to_text() const {
     return res;
 }
 
+namespace {
+// Dictionary keys of serialized tag nodes, interned once for the whole process
+struct tag_node_keys {
+    string_interner interner;
+    variant tag_name{interner.intern("tag_name")};
+    variant params{interner.intern("params")};
+    variant children{interner.intern("children")};
+};
+
+const tag_node_keys &get_tag_node_keys() {
+    static const tag_node_keys keys;
+    return keys;
+}
+} // namespace
+
 variant bbcode::tag_node::to_variant() const {
-    std::map<variant, variant> dict;
-    dict["tag_name"] = tag_name;
+    const auto &keys = get_tag_node_keys();
+    variant_dictionary dict;
+    dict.reserve(3);
+    dict[keys.tag_name] = tag_name;
 
     std::vector<variant> variant_params;
     variant_params.reserve(params.size());
     for (const auto &param : params) {
         variant_params.emplace_back(param);
     }
-    dict["params"] = variant_params;
+    dict[keys.params] = variant_params;
 
     std::vector<variant> variant_children;
     variant_children.reserve(children.size());
     for (const auto &child : children) {
         variant_children.push_back(child->to_variant());
     }
-    dict["children"] = variant_children;
+    dict[keys.children] = variant_children;
     return {dict};
 }
 
 bbcode::tag_node bbcode::tag_node::from_variant(const variant &v) {
     tag_node node;
-    auto dict = v.get_dictionary();
-    node.tag_name = dict["tag_name"].get_text();
-    auto variant_params = dict["params"].get_array();
+    const auto &keys = get_tag_node_keys();
+    const auto &dict = v.get_dictionary();
+    node.tag_name = dict.at(keys.tag_name).get_text();
+    const auto &variant_params = dict.at(keys.params).get_array();
     node.params.reserve(variant_params.size());
     for (const auto &param : variant_params) {
         node.params.push_back(param.get_text());
     }
-    auto variant_children = dict["children"].get_array();
+    const auto &variant_children = dict.at(keys.children).get_array();
     node.children.reserve(variant_children.size());
     for (const auto &child : variant_children) {
         switch (child.get_value_type()) {
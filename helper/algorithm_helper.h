@@ -7,6 +7,8 @@
 #include "variant.h"
 #include <functional>
 #include <memory>
+#include <optional>
+#include <span>
 #include <string_view>
 #include <unordered_map>
 #include <vector>
@@ -16,8 +18,22 @@ constexpr hash_t RESERVE_SIZE = 0x8000ULL;
 constexpr hash_t XXHASH_SEED = 431134ULL; // AELLEA
 
 boolean_t approx_equals(number_t a, number_t b);
+// Same tolerance as the scalar overload, applied component-wise; uses SSE2/NEON lanes where available
+boolean_t approx_equals(const number_t *p_a, const number_t *p_b, size_t count);
+// Compares old/new vectors pairwise, writing one result per pair into out (all spans must be the same size)
+void approx_equals_batch(std::span<const vector2> a, std::span<const vector2> b, std::span<boolean_t> out);
+void approx_equals_batch(std::span<const vector3> a, std::span<const vector3> b, std::span<boolean_t> out);
+void approx_equals_batch(std::span<const vector4> a, std::span<const vector4> b, std::span<boolean_t> out);
+
+enum easing_types : char { EASE_LINEAR, EASE_IN_QUAD, EASE_OUT_QUAD, EASE_IN_OUT_QUAD, EASE_IN_CUBIC, EASE_OUT_CUBIC, EASE_IN_OUT_CUBIC, EASE_SMOOTHSTEP };
+// Maps progress t (clamped to [0, 1]) through the easing curve
+number_t ease(easing_types type, number_t t);
+// Accepts the snake_case curve names ("linear", "in_out_quad", ...); unknown names yield std::nullopt
+std::optional<easing_types> parse_easing(std::string_view name);
+
 integer_t get_bbcode_string_length(const text_t &bbcode);
 hash_t calc_hash(const std::string &str) noexcept;
+hash_t calc_hash(std::string_view str) noexcept;
 consteval hash_t calc_hash_const(std::string_view str) noexcept {
     auto hash = constexpr_xxh3::XXH3_64bits_withSeed_const(str.data(), str.size(), XXHASH_SEED);
     if (hash >= RESERVE_SIZE) [[likely]] {
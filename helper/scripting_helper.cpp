@@ -235,7 +235,7 @@ variant scripting_engine::_lua_value_to_value(int stack_index, variant::types re
             return {get_type_mismatch_msg(variant::DICTIONARY), true};
         }
 
-        std::map<variant, variant> dictionary;
+        variant_dictionary::container_type pairs;
 
         // Iterate over table
         lua_pushnil(_p_state); // First key
@@ -258,12 +258,12 @@ variant scripting_engine::_lua_value_to_value(int stack_index, variant::types re
                 return {std::format("Error converting dictionary value: {}", value.get_text()), true};
             }
 
-            dictionary[std::move(key)] = std::move(value);
+            pairs.emplace_back(std::move(key), std::move(value));
 
             lua_pop(_p_state, 1); // Pop value, keep key for next iteration
         }
 
-        return {dictionary};
+        return {variant_dictionary(std::move(pairs))};
     }
     case variant::HASH: {
         if (lua_isnumber(_p_state, stack_index) != 0) {
@@ -3,18 +3,23 @@
 #include "camellia_typedef.h"
 #include "data/stage_data.h"
 #include "message.h"
+#include "message_generated.h"
 #include "node/stage.h"
 #include "stage_data_generated.h"
+#include <algorithm>
+#include <atomic>
 #include <format>
 
 namespace camellia {
 
 hash_t manager::register_stage_data(const std::shared_ptr<stage_data> &data) {
     if (data == nullptr) [[unlikely]] {
-        log("manager: data is nullptr.\n" + get_locator(), log_level::LOG_ERROR);
+        log("manager: data is nullptr.", log_level::LOG_ERROR, get_locator());
         return 0ULL;
     }
-    _stage_data_map.emplace(data->h_stage_name, data);
+    if (_stage_data_map.emplace(data->h_stage_name, data).second) {
+        _attribute_layouts.emplace(data->h_stage_name, std::make_shared<const attribute_layout_map>(attribute_layout::compile(data->actors)));
+    }
     return data->h_stage_name;
 }
 
@@ -24,12 +29,20 @@ hash_t manager::register_stage_data(const bytes_t &data) {
     return register_stage_data(sd);
 }
 
-void manager::unregister_stage_data(hash_t h_stage_name) { _stage_data_map.erase(h_stage_name); }
+void manager::unregister_stage_data(hash_t h_stage_name) {
+    _stage_data_map.erase(h_stage_name);
+    _attribute_layouts.erase(h_stage_name);
+}
+
+std::shared_ptr<const attribute_layout_map> manager::get_attribute_layouts(hash_t h_stage_name) const {
+    const auto it = _attribute_layouts.find(h_stage_name);
+    return it == _attribute_layouts.end() ? nullptr : it->second;
+}
 
 void manager::configure_stage(stage &s, hash_t h_stage_name) {
     auto it = _stage_data_map.find(h_stage_name);
     if (it == _stage_data_map.end()) {
-        log(std::format("manager: Stage data ({}) not found.\n{}", h_stage_name, get_locator()), log_level::LOG_ERROR);
+        log(std::format("manager: Stage data ({}) not found.", h_stage_name), log_level::LOG_ERROR, get_locator());
         return;
     }
     s.init(it->second, *this);
@@ -39,15 +52,216 @@ void manager::clean_stage(stage &s) const { s.fina(); }
 
 std::string manager::get_locator() const noexcept { return std::format("Manager({})", _name); }
 
-void manager::enqueue_event(const std::shared_ptr<event> &e) {
+void manager::enqueue_event(std::shared_ptr<event> e) {
     if (e == nullptr) [[unlikely]] {
-        log("manager: e is nullptr.\n" + get_locator(), log_level::LOG_ERROR);
+        log("manager: e is nullptr.", log_level::LOG_ERROR, get_locator());
         return;
     }
-    _event_queue.push_back(e);
+    if (_p_event_ring == nullptr) {
+        _event_queue.push_back(std::move(e));
+        return;
+    }
+
+    // Anything already waiting goes first, otherwise events would reach the consumer out of order
+    if ((_event_overflow.empty() || flush_event_overflow()) && _p_event_ring->try_push(std::move(e))) {
+        _event_ring_pushed_count.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    _event_ring_full_count.fetch_add(1, std::memory_order_relaxed);
+    _event_overflow.push_back(std::move(e));
+    _event_overflow_size.store(_event_overflow.size(), std::memory_order_relaxed);
+    if (_event_overflow.size() > _event_overflow_peak.load(std::memory_order_relaxed)) {
+        _event_overflow_peak.store(_event_overflow.size(), std::memory_order_relaxed);
+    }
 }
 
-void manager::log(text_t message, log_level level) { enqueue_event(std::make_shared<log_event>(std::move(message), level)); }
+const std::shared_ptr<attribute_value_log> &manager::get_attribute_value_log() {
+    if (_p_value_log != nullptr) [[likely]] {
+        return _p_value_log;
+    }
+
+    for (const auto &p_log : _value_log_pool) {
+        if (p_log.use_count() == 1) {
+            // Pairs with the release of the last event reference, which may have been dropped on the consumer thread
+            std::atomic_thread_fence(std::memory_order_acquire);
+            p_log->clear();
+            _p_value_log = p_log;
+            return _p_value_log;
+        }
+    }
+    _p_value_log = _value_log_pool.emplace_back(std::make_shared<attribute_value_log>());
+    return _p_value_log;
+}
+
+size_t manager::coalesce_events() {
+    _coalesce_targets.clear();
+    _coalesce_merged.clear();
+
+    size_t events_in = 0;
+    size_t kept = 0;
+    for (size_t i = 0; i < _event_queue.size(); i++) {
+        auto &e = _event_queue[i];
+        switch (e->get_event_type()) {
+        case EVENT_NODE_ATTRIBUTE_DIRTY: {
+            events_in++;
+            const auto &dirty_event = static_cast<const node_attribute_dirty_event &>(*e);
+            const auto [it, is_first] = _coalesce_targets.try_emplace(dirty_event.node_handle, kept, false);
+            if (!is_first) {
+                // Targets are never behind kept, so they have already been moved to their final position
+                auto &[target_index, is_copy] = it->second;
+                auto &p_target = _event_queue[target_index];
+                const auto &target = static_cast<const node_attribute_dirty_event &>(*p_target);
+                if (target.p_values == dirty_event.p_values) {
+                    if (!is_copy) {
+                        // Whoever copied the queue may still hold the target, so the merge goes into a new event
+                        node_attribute_dirty_event::dirty_attributes_vector attributes(target.dirty_attributes, get_event_resource());
+                        p_target = std::allocate_shared<node_attribute_dirty_event>(shared_resource_allocator<node_attribute_dirty_event>(_p_event_pool),
+                                                                                    target.node_handle, std::move(attributes), target.p_values);
+                        is_copy = true;
+                        _coalesce_merged.push_back(target_index);
+                    }
+                    auto &merged = static_cast<node_attribute_dirty_event &>(*p_target).dirty_attributes;
+                    merged.insert(merged.end(), dirty_event.dirty_attributes.begin(), dirty_event.dirty_attributes.end());
+                    continue;
+                }
+                // Values owned by another log would not be kept alive by the target, this event becomes the new target
+                it->second = {kept, false};
+            }
+            break;
+        }
+        default:
+            // Merging a later change into an earlier target would move it ahead of this event
+            _coalesce_targets.clear();
+            break;
+        }
+
+        if (kept != i) {
+            _event_queue[kept] = std::move(e);
+        }
+        kept++;
+    }
+    const auto removed = _event_queue.size() - kept;
+    _event_queue.erase(_event_queue.begin() + static_cast<std::ptrdiff_t>(kept), _event_queue.end());
+
+    // Each merged copy is listed once; sorting is stable, so the last value of each key is the last of its run
+    for (const auto index : _coalesce_merged) {
+        auto &attributes = static_cast<node_attribute_dirty_event &>(*_event_queue[index]).dirty_attributes;
+        std::stable_sort(attributes.begin(), attributes.end(), [](const auto &a, const auto &b) { return a.first < b.first; });
+        size_t written = 0;
+        for (size_t i = 0; i < attributes.size(); i++) {
+            if (i + 1 < attributes.size() && attributes[i + 1].first == attributes[i].first) {
+                continue;
+            }
+            attributes[written++] = std::move(attributes[i]);
+        }
+        attributes.erase(attributes.begin() + static_cast<std::ptrdiff_t>(written), attributes.end());
+    }
+
+    _coalescing_statistics.events_in += events_in;
+    _coalescing_statistics.events_out += events_in - removed;
+    return removed;
+}
+
+size_t manager::flush_events(flatbuffers::FlatBufferBuilder &builder) {
+    if (_p_event_ring != nullptr) [[unlikely]] {
+        log("manager: flush_events() is not available while the event ring is enabled.", log_level::LOG_ERROR, get_locator());
+        return 0;
+    }
+
+    coalesce_events();
+    // Copies of the queue outlive the flush, and the nodes their locators point to may be gone by the time they are read
+    resolve_log_locators();
+    _batch_types.clear();
+    _batch_offsets.clear();
+    _batch_types.reserve(_event_queue.size());
+    _batch_offsets.reserve(_event_queue.size());
+    for (const auto &e : _event_queue) {
+        const auto type = e->get_flatbuffers_type();
+        if (type == fb::EventData_NONE) [[unlikely]] {
+            continue;
+        }
+        _batch_types.push_back(type);
+        _batch_offsets.push_back(e->to_flatbuffers(builder));
+    }
+    _event_queue.clear();
+
+    const auto types_offset = builder.CreateVector(_batch_types);
+    const auto events_offset = builder.CreateVector(_batch_offsets);
+    builder.Finish(fb::CreateEventBatch(builder, types_offset, events_offset));
+    release_attribute_value_log();
+    return _batch_offsets.size();
+}
+
+void manager::enable_event_ring(size_t capacity) {
+    _p_event_ring = std::make_unique<spsc_ring<std::shared_ptr<event>>>(capacity);
+    _event_overflow.clear();
+    _event_ring_pushed_count.store(0, std::memory_order_relaxed);
+    _event_ring_full_count.store(0, std::memory_order_relaxed);
+    _event_overflow_size.store(0, std::memory_order_relaxed);
+    _event_overflow_peak.store(0, std::memory_order_relaxed);
+}
+
+boolean_t manager::flush_event_overflow() {
+    if (_p_event_ring == nullptr) {
+        return true;
+    }
+    size_t pushed = 0;
+    while (!_event_overflow.empty() && _p_event_ring->try_push(std::move(_event_overflow.front()))) {
+        _event_overflow.pop_front();
+        pushed++;
+    }
+    if (pushed > 0) {
+        _event_ring_pushed_count.fetch_add(pushed, std::memory_order_relaxed);
+        _event_overflow_size.store(_event_overflow.size(), std::memory_order_relaxed);
+    }
+    return _event_overflow.empty();
+}
+
+event_ring_statistics manager::get_event_ring_statistics() const noexcept {
+    return {.pushed_count = _event_ring_pushed_count.load(std::memory_order_relaxed),
+            .full_count = _event_ring_full_count.load(std::memory_order_relaxed),
+            .overflow_size = _event_overflow_size.load(std::memory_order_relaxed),
+            .overflow_peak = _event_overflow_peak.load(std::memory_order_relaxed)};
+}
+
+void manager::log(text_t message, log_level level) {
+    if (!is_log_enabled(level)) {
+        return;
+    }
+    enqueue_event<log_event>(std::move(message), level);
+}
+
+void manager::log(text_t message, log_level level, std::string locator) {
+    if (!is_log_enabled(level)) {
+        return;
+    }
+    enqueue_event<log_event>(std::move(message), level, std::move(locator));
+}
+
+void manager::log(text_t message, log_level level, std::function<std::string()> locator_source) {
+    if (!is_log_enabled(level)) {
+        return;
+    }
+    if (_p_event_ring != nullptr) {
+        enqueue_event<log_event>(std::move(message), level, locator_source());
+        return;
+    }
+    enqueue_event<log_event>(std::move(message), level, std::move(locator_source));
+    _pending_locator_count++;
+}
+
+void manager::resolve_log_locators() {
+    if (_pending_locator_count == 0) [[likely]] {
+        return;
+    }
+    for (const auto &e : _event_queue) {
+        if (e->get_event_type() == EVENT_LOG) {
+            static_cast<log_event &>(*e).resolve_locator();
+        }
+    }
+    _pending_locator_count = 0;
+}
 
 unsigned int manager::_next_id = 1U;
 
@@ -58,7 +272,7 @@ node::node(manager *p_mgr) : _handle(static_cast<hash_t>(p_mgr->get_id()) << 32U
 void node::_set_fail(text_t message) const noexcept {
     _state = state::FAILED;
     _error_message = std::move(message);
-    _p_mgr->enqueue_event(std::make_shared<node_failure_event>(*this, _error_message));
+    _p_mgr->enqueue_event<node_failure_event>(*this, _error_message);
 }
 
 } // namespace camellia
\ No newline at end of file
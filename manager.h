@@ -1,10 +1,19 @@
 #ifndef CAMELLIA_MANAGER_H
 #define CAMELLIA_MANAGER_H
 
+#include "attribute_layout.h"
 #include "camellia_macro.h"
 #include "camellia_typedef.h"
+#include "frame_arena.h"
 #include "message.h"
+#include "spsc_ring.h"
+#include "string_interner.h"
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <functional>
 #include <memory>
+#include <memory_resource>
 #include <unordered_map>
 #include <utility>
 #include <vector>
@@ -16,6 +25,26 @@ struct stage_data;
 class stage;
 class manager;
 
+// Allocates from a shared memory resource and keeps it alive. Events hold one in their control block, so the event
+// pool is only destroyed once the manager and every event allocated from it are gone.
+template <typename T> class shared_resource_allocator {
+public:
+    using value_type = T;
+
+    explicit shared_resource_allocator(std::shared_ptr<std::pmr::memory_resource> p_resource) noexcept : _p_resource(std::move(p_resource)) {}
+    template <typename U> explicit(false) shared_resource_allocator(const shared_resource_allocator<U> &other) noexcept : _p_resource(other._p_resource) {}
+
+    [[nodiscard]] T *allocate(size_t n) { return static_cast<T *>(_p_resource->allocate(n * sizeof(T), alignof(T))); }
+    void deallocate(T *p, size_t n) noexcept { _p_resource->deallocate(p, n * sizeof(T), alignof(T)); }
+
+    template <typename U> bool operator==(const shared_resource_allocator<U> &other) const noexcept { return _p_resource == other._p_resource; }
+
+private:
+    template <typename U> friend class shared_resource_allocator;
+
+    std::shared_ptr<std::pmr::memory_resource> _p_resource;
+};
+
 class node {
 public:
     enum class state : char { UNINITIALIZED = 0, READY = 1, FAILED = 2 };
@@ -55,6 +84,30 @@ protected:
     static unsigned int _next_id;
 };
 
+// How far an attribute may move before the change is reported. A non-zero quantization_step snaps numbers and vector
+// components to multiples of the step; threshold is the largest per-component difference still treated as unchanged.
+struct attribute_tolerance {
+    number_t threshold{0.0F};
+    number_t quantization_step{0.0F};
+};
+
+// Backpressure seen by the producer side of the event ring
+struct event_ring_statistics {
+    // Events that entered the ring
+    size_t pushed_count{0};
+    // Enqueues that found the ring full and had to wait in the overflow queue
+    size_t full_count{0};
+    // Events waiting in the overflow queue now, and the most that ever waited at once
+    size_t overflow_size{0};
+    size_t overflow_peak{0};
+};
+
+// Attribute dirty events before and after coalesce_events(), summed over every call
+struct event_coalescing_statistics {
+    size_t events_in{0};
+    size_t events_out{0};
+};
+
 class manager {
     NAMED_CLASS(manager)
 
@@ -64,31 +117,130 @@ public:
     hash_t register_stage_data(const bytes_t &data);
     // Dereference a stage data from the manager
     void unregister_stage_data(hash_t h_stage_name);
+    // Attribute layouts compiled from the stage data when it was registered, nullptr for unknown stages
+    [[nodiscard]] std::shared_ptr<const attribute_layout_map> get_attribute_layouts(hash_t h_stage_name) const;
     // Initialize a stage instance with the specified stage data
     void configure_stage(stage &s, hash_t h_stage_name);
     // Do some clean up for a stage instance so it can be configured again
     void clean_stage(stage &s) const;
 
     void log(text_t message, log_level level);
+    // The locator is kept apart from the message and only joined to it when the event is serialized
+    void log(text_t message, log_level level, std::string locator);
+    // The locator is formatted by locator_source when the event is serialized or resolve_log_locators() runs. With the
+    // event ring it is formatted right away, since the consumer thread must not call into nodes.
+    void log(text_t message, log_level level, std::function<std::string()> locator_source);
+    // Formats the locators still pending in the event queue. Nodes call this before they are finalized, so a locator
+    // never outlives what it describes; read log events copied out of the queue only after this.
+    void resolve_log_locators();
+    // Messages below this level are dropped; the logging macros skip building them altogether
+    void set_min_log_level(log_level level) noexcept { _min_log_level = level; }
+    [[nodiscard]] log_level get_min_log_level() const noexcept { return _min_log_level; }
+    [[nodiscard]] boolean_t is_log_enabled(log_level level) const noexcept { return level >= _min_log_level; }
 
     explicit manager(text_t name) : _name(std::move(name)), _id(_next_id++) {}
 
     [[nodiscard]] const text_t &get_name() const noexcept { return _name; }
     [[nodiscard]] std::string get_locator() const noexcept;
 
-    template <event_derived T, typename... Args> void enqueue_event(Args &&...args) { enqueue_event(std::make_shared<T>(std::forward<Args>(args)...)); }
-    void enqueue_event(const std::shared_ptr<event> &e);
+    // Events are allocated from the event pool together with their control block, which also keeps the pool alive
+    template <event_derived T, typename... Args> void enqueue_event(Args &&...args) {
+        enqueue_event(std::allocate_shared<T>(shared_resource_allocator<T>(_p_event_pool), std::forward<Args>(args)...));
+    }
+    void enqueue_event(std::shared_ptr<event> e);
+
+    // Dirty events copy their values here. All events queued between two drains share one log; draining the queue, or
+    // every stage::update when the event ring is used, releases it and the next call starts another. Logs no longer
+    // referenced by any event are cleared and reused.
+    [[nodiscard]] const std::shared_ptr<attribute_value_log> &get_attribute_value_log();
+    void release_attribute_value_log() noexcept { _p_value_log = nullptr; }
+
+    // Events and the buffers they own come from here. Blocks freed by consumed events are reused by later ones, so once
+    // the pool has warmed up, dirty and node events are enqueued without reaching the heap; log_event text is still a
+    // heap string. Events may outlive the manager, the pool stays alive until the last of them is released.
+    [[nodiscard]] std::pmr::memory_resource *get_event_resource() noexcept { return _p_event_pool.get(); }
 
     const std::vector<std::shared_ptr<event>> &get_event_queue() const noexcept { return _event_queue; }
-    void clear_event_queue() noexcept { _event_queue.clear(); }
+    void clear_event_queue() noexcept {
+        // Copies of the events may still be read
+        resolve_log_locators();
+        _event_queue.clear();
+        release_attribute_value_log();
+    }
+    // Merges the attribute dirty events queued for the same node into the first of them, keeping the last value
+    // written per attribute. Only runs of consecutive dirty events are merged: any other event (log, node init, fina,
+    // failure, visibility, ...) ends the run, so every change still arrives on the same side of it as before. Within a
+    // run, a node's later changes may move ahead of other nodes' dirty events. Returns the number of events removed
+    // from the queue.
+    size_t coalesce_events();
+    [[nodiscard]] const event_coalescing_statistics &get_event_coalescing_statistics() const noexcept { return _coalescing_statistics; }
+
+    // Coalesces, then encodes the whole event queue into one EventBatch, finishes builder with it and clears the queue. Returns the
+    // number of events written. Only for the event queue: once the event ring is enabled its consumer thread owns the events,
+    // draining the ring here would make this a second consumer, so it logs an error, leaves builder untouched and returns 0.
+    size_t flush_events(flatbuffers::FlatBufferBuilder &builder);
+
+    // From now on events go through a lock-free ring that one other thread drains while this one keeps producing,
+    // instead of the event queue. Events that find the ring full wait in order in an overflow queue.
+    void enable_event_ring(size_t capacity);
+    [[nodiscard]] spsc_ring<std::shared_ptr<event>> *get_event_ring() noexcept { return _p_event_ring.get(); }
+    // Producer side. Moves waiting overflow events into the ring, returns false if some are still waiting.
+    boolean_t flush_event_overflow();
+    // Safe to call from the consumer thread
+    [[nodiscard]] event_ring_statistics get_event_ring_statistics() const noexcept;
+
+    // Text values repeated across frames and nodes (e.g. dialog text) are interned here
+    [[nodiscard]] string_interner &get_string_interner() noexcept { return _string_interner; }
+
+    // Backs per-frame temporaries; reset at the start of every stage::update
+    [[nodiscard]] frame_arena &get_frame_arena() noexcept { return _frame_arena; }
+
+    // Applied to actor attribute registries when their actor is initialized
+    void set_attribute_tolerance(hash_t h_attribute_name, attribute_tolerance tolerance) { _attribute_tolerances[h_attribute_name] = tolerance; }
+    [[nodiscard]] const std::unordered_map<hash_t, attribute_tolerance> &get_attribute_tolerances() const noexcept { return _attribute_tolerances; }
+
+    // Number of past changes each actor keeps per attribute for rewinding, 0 keeps none
+    void set_attribute_history_capacity(size_t capacity) noexcept { _attribute_history_capacity = capacity; }
+    [[nodiscard]] size_t get_attribute_history_capacity() const noexcept { return _attribute_history_capacity; }
+
+    // Dirty events that were not sent because every change in them fell within its tolerance
+    [[nodiscard]] size_t get_suppressed_dirty_event_count() const noexcept { return _suppressed_dirty_event_count; }
+    void count_suppressed_dirty_event() noexcept { _suppressed_dirty_event_count++; }
 
 private:
     friend class node;
 
     // Maps hashes to stage data
     std::unordered_map<hash_t, std::shared_ptr<stage_data>> _stage_data_map;
+    std::unordered_map<hash_t, std::shared_ptr<const attribute_layout_map>> _attribute_layouts;
 
+    // Shared with every event allocated from it. Synchronized because the last reference to an event may be dropped
+    // on the event ring's consumer thread.
+    std::shared_ptr<std::pmr::memory_resource> _p_event_pool{std::make_shared<std::pmr::synchronized_pool_resource>()};
     std::vector<std::shared_ptr<event>> _event_queue;
+    std::shared_ptr<attribute_value_log> _p_value_log;
+    std::vector<std::shared_ptr<attribute_value_log>> _value_log_pool;
+    event_coalescing_statistics _coalescing_statistics;
+    // Scratch space of coalesce_events() and flush_events(), kept to avoid reallocating every frame
+    // node handle -> (queue index of its target, whether the target is already a merged copy)
+    std::unordered_map<hash_t, std::pair<size_t, boolean_t>> _coalesce_targets;
+    std::vector<size_t> _coalesce_merged;
+    std::vector<uint8_t> _batch_types;
+    std::vector<flatbuffers::Offset<void>> _batch_offsets;
+    std::unique_ptr<spsc_ring<std::shared_ptr<event>>> _p_event_ring;
+    std::deque<std::shared_ptr<event>> _event_overflow;
+    std::atomic<size_t> _event_ring_pushed_count{0};
+    std::atomic<size_t> _event_ring_full_count{0};
+    std::atomic<size_t> _event_overflow_size{0};
+    std::atomic<size_t> _event_overflow_peak{0};
+    string_interner _string_interner;
+    frame_arena _frame_arena;
+    std::unordered_map<hash_t, attribute_tolerance> _attribute_tolerances;
+    size_t _suppressed_dirty_event_count{0};
+    // Log events in the queue whose locator_source has not run yet
+    size_t _pending_locator_count{0};
+    log_level _min_log_level{LOG_DEBUG};
+    size_t _attribute_history_capacity{0};
     text_t _name;
 
     unsigned int _id{0U};
@@ -7,6 +7,25 @@
 namespace camellia {
 using namespace serialization_helper;
 
+uint8_t event::get_flatbuffers_type() const {
+    switch (get_event_type()) {
+    case EVENT_NODE_INIT:
+        return fb::EventData_NodeInitEvent;
+    case EVENT_NODE_FINA:
+        return fb::EventData_NodeFinaEvent;
+    case EVENT_NODE_VISIBILITY_UPDATE:
+        return fb::EventData_NodeVisibilityUpdateEvent;
+    case EVENT_NODE_ATTRIBUTE_DIRTY:
+        return fb::EventData_NodeAttributeDirtyEvent;
+    case EVENT_NODE_FAILURE:
+        return fb::EventData_NodeFailureEvent;
+    case EVENT_LOG:
+        return fb::EventData_LogEvent;
+    default:
+        return fb::EventData_NONE;
+    }
+}
+
 node_event::node_event(const node &n) : node_handle(n.get_handle()) {}
 
 flatbuffers::Offset<void> node_event::to_flatbuffers(flatbuffers::FlatBufferBuilder &builder) const { return fb::CreateNodeEvent(builder, node_handle).o; }
@@ -41,7 +60,9 @@ flatbuffers::Offset<void> node_attribute_dirty_event::to_flatbuffers(flatbuffers
     std::vector<flatbuffers::Offset<fb::AttributeValuePair>> dirty_attributes_offset;
     dirty_attributes_offset.reserve(dirty_attributes.size());
     for (const auto &dirty_attribute : dirty_attributes) {
-        dirty_attributes_offset.push_back(fb::CreateAttributeValuePair(builder, dirty_attribute.first, dirty_attribute.second->to_flatbuffers(builder)));
+        // Removed attributes are reported as VOID
+        const auto value_offset = dirty_attribute.second != nullptr ? dirty_attribute.second->to_flatbuffers(builder) : variant().to_flatbuffers(builder);
+        dirty_attributes_offset.push_back(fb::CreateAttributeValuePair(builder, dirty_attribute.first, value_offset));
     }
     return fb::CreateNodeAttributeDirtyEvent(builder, base_node.o, builder.CreateVector(dirty_attributes_offset)).o;
 }
@@ -52,8 +73,20 @@ flatbuffers::Offset<void> node_failure_event::to_flatbuffers(flatbuffers::FlatBu
     return fb::CreateNodeFailureEvent(builder, base_node.o, error_message_offset).o;
 }
 
+void log_event::resolve_locator() {
+    if (locator_source) {
+        locator = locator_source();
+        locator_source = nullptr;
+    }
+}
+
+text_t log_event::get_text() const {
+    const auto resolved = locator_source ? locator_source() : locator;
+    return resolved.empty() ? message : message + "\n" + resolved;
+}
+
 flatbuffers::Offset<void> log_event::to_flatbuffers(flatbuffers::FlatBufferBuilder &builder) const {
-    auto message_offset = builder.CreateString(message.c_str());
+    auto message_offset = locator.empty() && !locator_source ? builder.CreateString(message) : builder.CreateString(get_text());
     return fb::CreateLogEvent(builder, message_offset, static_cast<fb::LogLevel>(level)).o;
 }
 
@@ -1,13 +1,20 @@
 #ifndef MESSAGE_H
 #define MESSAGE_H
 
+#include "attribute_value_log.h"
 #include "camellia_typedef.h"
 #include "variant.h"
 #include <flatbuffers/buffer.h>
 
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <memory_resource>
+#include <string>
 #include <type_traits>
 #include <utility>
 #include <variant>
+#include <vector>
 
 namespace camellia {
 
@@ -30,6 +37,8 @@ enum event_types : char {
 struct event {
     [[nodiscard]] virtual event_types get_event_type() const = 0;
     [[nodiscard]] virtual flatbuffers::Offset<void> to_flatbuffers(flatbuffers::FlatBufferBuilder &builder) const = 0;
+    // The fb::EventData member to_flatbuffers() writes, fb::EventData_NONE for events without one
+    [[nodiscard]] uint8_t get_flatbuffers_type() const;
 
     virtual ~event() = default;
     event() = default;
@@ -43,6 +52,7 @@ struct node_event : public event {
     hash_t node_handle{0ULL};
 
     explicit node_event(const node &n);
+    explicit node_event(hash_t node_handle) : node_handle(node_handle) {}
     [[nodiscard]] flatbuffers::Offset<void> to_flatbuffers(flatbuffers::FlatBufferBuilder &builder) const override;
 };
 
@@ -70,11 +80,17 @@ struct node_visibility_update_event : public node_event {
 };
 
 struct node_attribute_dirty_event : public node_event {
-    using dirty_attributes_vector = std::vector<std::pair<hash_t, const variant *>>;
+    // Allocated from manager::get_event_resource() by the nodes that send the event
+    using dirty_attributes_vector = std::pmr::vector<std::pair<hash_t, const variant *>>;
     dirty_attributes_vector dirty_attributes;
-
-    explicit node_attribute_dirty_event(const node &n, dirty_attributes_vector dirty_attributes)
-        : node_event(n), dirty_attributes(std::move(dirty_attributes)) {}
+    // Owns the values dirty_attributes points to, so they stay valid after the registry changes. Without it the
+    // pointers are borrowed from the caller.
+    std::shared_ptr<const attribute_value_log> p_values;
+
+    explicit node_attribute_dirty_event(const node &n, dirty_attributes_vector dirty_attributes, std::shared_ptr<const attribute_value_log> p_values = nullptr)
+        : node_event(n), dirty_attributes(std::move(dirty_attributes)), p_values(std::move(p_values)) {}
+    explicit node_attribute_dirty_event(hash_t node_handle, dirty_attributes_vector dirty_attributes, std::shared_ptr<const attribute_value_log> p_values = nullptr)
+        : node_event(node_handle), dirty_attributes(std::move(dirty_attributes)), p_values(std::move(p_values)) {}
     [[nodiscard]] flatbuffers::Offset<void> to_flatbuffers(flatbuffers::FlatBufferBuilder &builder) const override;
     [[nodiscard]] event_types get_event_type() const override { return EVENT_NODE_ATTRIBUTE_DIRTY; }
 };
@@ -88,10 +104,23 @@ struct node_failure_event : public node_event {
 };
 
 struct log_event : public event {
+    // The logged text only. The locator is kept apart and appended by get_text() and in the serialized event, which
+    // read the same as the single message string used to.
     text_t message;
     log_level level{LOG_DEBUG};
-
-    explicit log_event(text_t message, log_level level) : message(std::move(message)), level(level) {}
+    // Where the message came from, empty if unknown
+    std::string locator;
+    // Formats the locator on demand until resolve_locator() stores it; only set while the event waits in the queue
+    std::function<std::string()> locator_source;
+
+    explicit log_event(text_t message, log_level level, std::string locator = {})
+        : message(std::move(message)), level(level), locator(std::move(locator)) {}
+    log_event(text_t message, log_level level, std::function<std::string()> locator_source)
+        : message(std::move(message)), level(level), locator_source(std::move(locator_source)) {}
+
+    void resolve_locator();
+    // The message followed by its locator, as it is serialized
+    [[nodiscard]] text_t get_text() const;
 
     [[nodiscard]] flatbuffers::Offset<void> to_flatbuffers(flatbuffers::FlatBufferBuilder &builder) const override;
     [[nodiscard]] event_types get_event_type() const override { return EVENT_LOG; }
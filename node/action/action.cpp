@@ -2,9 +2,11 @@
 #include "attribute_registry.h"
 #include "camellia_macro.h"
 #include "node/stage.h"
+#include <cmath>
 #include <format>
 #include <memory>
 #include <set>
+#include <variant>
 
 namespace camellia {
 action_timeline_keyframe &action::get_parent_keyframe() const {
@@ -23,6 +25,7 @@ void action::init(const std::shared_ptr<action_data> &data, action_timeline_keyf
 }
 
 void action::fina() {
+    get_manager().resolve_log_locators();
     _state = state::UNINITIALIZED;
     _error_message.clear();
     _p_base_data = nullptr;
@@ -76,8 +79,13 @@ void modifier_action::init(const std::shared_ptr<action_data> &data, action_time
 
     _p_parent = p_parent;
     _p_timeline = static_cast<action_timeline_keyframe *>(_p_parent)->get_parent_timeline();
+    _p_layout = _p_timeline != nullptr ? _p_timeline->get_attribute_layout() : nullptr;
+    _attribute_slot = _p_layout != nullptr ? _p_layout->find_slot(mad->h_attribute_name) : attribute_layout::INVALID_SLOT;
 
-    _p_script = new scripting_helper::scripting_engine();
+    _is_native = mad->h_script_name == algorithm_helper::calc_hash(NATIVE_LERP_NAME);
+    if (!_is_native) {
+        _p_script = new scripting_helper::scripting_engine();
+    }
 
     std::set<text_t> seen;
     auto process_params = [&](const std::map<text_t, variant> &params) {
@@ -88,6 +96,8 @@ void modifier_action::init(const std::shared_ptr<action_data> &data, action_time
 
             if (p.second.get_value_type() == variant::types::HASH) {
                 _ref_params[p.first] = static_cast<hash_t>(p.second);
+            } else if (_is_native) {
+                _native_params[p.first] = p.second;
             } else {
                 _p_script->set_property(p.first, p.second);
             }
@@ -99,6 +109,22 @@ void modifier_action::init(const std::shared_ptr<action_data> &data, action_time
     process_params(*p_parent->get_override_params());
     process_params(mad->default_params);
 
+    if (_is_native) {
+        FAIL_LOG_IF(!_native_params.contains(TO_NAME) && !_ref_params.contains(TO_NAME),
+                    std::format("Missing param '{}' for built-in modifier action ({}).", TO_NAME, mad->h_action_name));
+
+        _easing = algorithm_helper::EASE_LINEAR;
+        const auto it = _native_params.find(EASING_NAME);
+        if (it != _native_params.end()) {
+            const auto easing = it->second.get_value_type() == variant::TEXT ? algorithm_helper::parse_easing(it->second.get_text()) : std::nullopt;
+            FAIL_LOG_IF(!easing.has_value(), std::format("Unknown easing ({}) for built-in modifier action ({}).", it->second.to_desc(), mad->h_action_name));
+            _easing = *easing;
+        }
+
+        action::init(data, p_parent);
+        return;
+    }
+
     auto *parent_timeline = p_parent->get_parent_timeline();
     auto *stage_ptr = parent_timeline ? parent_timeline->get_stage() : nullptr;
     const auto *code = stage_ptr ? stage_ptr->get_script_code(mad->h_script_name) : nullptr;
@@ -121,7 +147,11 @@ void modifier_action::fina() {
     action::fina();
 
     _p_timeline = nullptr;
+    _p_layout = nullptr;
+    _attribute_slot = attribute_layout::INVALID_SLOT;
     final_value = variant();
+    _is_native = false;
+    _native_params.clear();
 
     if (_p_script != nullptr) {
         delete _p_script;
@@ -130,7 +160,7 @@ void modifier_action::fina() {
 }
 
 variant modifier_action::apply_modifier(const number_t action_time, const hash_t h_attribute_name, const variant &val,
-                                        std::vector<std::map<hash_t, variant>> &ref_attributes) const {
+                                        const frame_attribute_stack &ref_attributes) const {
     REQUIRES_READY_RETURN(*this, val);
     if (get_attribute_name_hash() != h_attribute_name) {
         return val;
@@ -138,16 +168,22 @@ variant modifier_action::apply_modifier(const number_t action_time, const hash_t
     return modify(action_time, val, ref_attributes);
 }
 
-void modifier_action::apply_modifier(const number_t action_time, std::map<hash_t, variant> &attributes,
-                                     std::vector<std::map<hash_t, variant>> &ref_attributes) const {
+void modifier_action::apply_modifier(const number_t action_time, frame_attribute_layer &attributes, const frame_attribute_stack &ref_attributes) const {
     REQUIRES_READY(*this);
-    const auto it = attributes.find(get_attribute_name_hash());
-    if (it == attributes.end()) {
+    // Layers of actors with a layout are addressed through the slot resolved in init()
+    const auto use_slot = _attribute_slot != attribute_layout::INVALID_SLOT && attributes.get_layout() == _p_layout;
+    const auto *p_value = use_slot ? attributes.find_at(_attribute_slot) : attributes.find(get_attribute_name_hash());
+    if (p_value == nullptr) {
         // TODO: Report warning
         return;
     }
 
-    attributes[get_attribute_name_hash()] = modify(action_time, it->second, ref_attributes);
+    auto value = modify(action_time, *p_value, ref_attributes);
+    if (use_slot) {
+        attributes.set_at(_attribute_slot, std::move(value));
+    } else {
+        attributes.set(get_attribute_name_hash(), std::move(value));
+    }
 }
 
 const char *modifier_action::TIME_NAME = "time";
@@ -155,9 +191,13 @@ const char *modifier_action::DURATION_NAME = "duration";
 const char *modifier_action::ORIG_NAME = "orig";
 const char *modifier_action::RUN_NAME = "run";
 
-variant modifier_action::modify(const number_t action_time, const variant &base_value, std::vector<std::map<hash_t, variant>> &ref_attributes) const {
+variant modifier_action::modify(const number_t action_time, const variant &base_value, const frame_attribute_stack &ref_attributes) const {
     REQUIRES_READY_RETURN(*this, variant());
 
+    if (_is_native) {
+        return modify_native(action_time, base_value, ref_attributes);
+    }
+
     try {
         // set built-in constants
         _p_script->set_property(TIME_NAME, action_time);
@@ -165,17 +205,11 @@ variant modifier_action::modify(const number_t action_time, const variant &base_
         _p_script->set_property(ORIG_NAME, base_value);
 
         for (const auto &p : _ref_params) {
-            int i = 0;
-            for (; i < ref_attributes.size(); i++) {
-                const auto it = ref_attributes[i].find(p.second);
-                if (it != ref_attributes[i].end()) {
-                    _p_script->set_property(p.first, it->second);
-                    break;
-                }
-            }
-            if (i >= ref_attributes.size()) {
+            const auto *p_value = find_ref_attribute(p.second, ref_attributes);
+            if (p_value == nullptr) {
                 FAIL_LOG_RETURN(std::format("Failed to find referenced attribute ({}) for modifier action.", p.second), variant());
             }
+            _p_script->set_property(p.first, *p_value);
         }
 
         return _p_script->guarded_invoke(RUN_NAME, 0, nullptr, get_value_type());
@@ -189,6 +223,47 @@ variant modifier_action::modify(const number_t action_time, const variant &base_
     }
 }
 
+variant modifier_action::modify_native(const number_t action_time, const variant &base_value, const frame_attribute_stack &ref_attributes) const {
+    auto find_param = [&](const text_t &name, const variant *fallback) -> const variant * {
+        if (const auto it = _native_params.find(name); it != _native_params.end()) {
+            return &it->second;
+        }
+        if (const auto it = _ref_params.find(name); it != _ref_params.end()) {
+            return find_ref_attribute(it->second, ref_attributes);
+        }
+        return fallback;
+    };
+
+    const auto *p_from = find_param(FROM_NAME, &base_value);
+    const auto *p_to = find_param(TO_NAME, nullptr);
+    if (p_from == nullptr || p_to == nullptr) {
+        FAIL_LOG_RETURN(std::format("Failed to find referenced attribute for built-in modifier action ({}).", get_data()->h_action_name), variant());
+    }
+
+    const auto duration = get_actual_duration();
+    const auto t = algorithm_helper::ease(_easing, duration > 0.0F ? action_time / duration : 1.0F);
+    try {
+        auto res = variant::lerp(*p_from, *p_to, t);
+        if (get_value_type() == variant::INTEGER) {
+            return {static_cast<integer_t>(std::lround(static_cast<number_t>(res)))};
+        }
+        return res;
+    } catch (const std::bad_variant_access &) {
+        FAIL_LOG_RETURN(std::format("Cannot interpolate from {} to {} in built-in modifier action ({}).", p_from->to_desc(), p_to->to_desc(),
+                                    get_data()->h_action_name),
+                        variant());
+    }
+}
+
+const variant *modifier_action::find_ref_attribute(const hash_t h_attribute_name, const frame_attribute_stack &attributes) {
+    for (const auto &layer : attributes) {
+        if (const auto *p_value = layer.find(h_attribute_name); p_value != nullptr) {
+            return p_value;
+        }
+    }
+    return nullptr;
+}
+
 void composite_action::init(const std::shared_ptr<action_data> &data, action_timeline_keyframe *p_parent) {
     const auto cad = std::dynamic_pointer_cast<composite_action_data>(data);
     REQUIRES_NOT_NULL_MSG(cad, std::format("Failed to cast action data ({}) to composite action data.", data->h_action_name));
@@ -197,7 +272,7 @@ void composite_action::init(const std::shared_ptr<action_data> &data, action_tim
     auto *parent_timeline = p_parent->get_parent_timeline();
     auto *stage_ptr = parent_timeline ? parent_timeline->get_stage() : nullptr;
     REQUIRES_NOT_NULL_MSG(stage_ptr, "Failed to get stage from parent timeline.");
-    _p_timeline->init({cad->timeline}, *stage_ptr, this);
+    _p_timeline->init({cad->timeline}, *stage_ptr, this, parent_timeline->get_attribute_layout());
 
     action::init(data, p_parent);
 }
@@ -5,6 +5,7 @@
 #include "camellia_macro.h"
 #include "camellia_typedef.h"
 #include "data/stage_data.h"
+#include "helper/algorithm_helper.h"
 #include "helper/scripting_helper.h"
 #include "variant.h"
 #include <map>
@@ -68,13 +69,19 @@ public:
 
     void fina() override;
 
-    [[nodiscard]] variant apply_modifier(number_t action_time, hash_t h_attribute_name, const variant &val,
-                                         std::vector<std::map<hash_t, variant>> &ref_attributes) const;
+    [[nodiscard]] variant apply_modifier(number_t action_time, hash_t h_attribute_name, const variant &val, const frame_attribute_stack &ref_attributes) const;
 
-    void apply_modifier(number_t action_time, std::map<hash_t, variant> &attributes, std::vector<std::map<hash_t, variant>> &ref_attributes) const;
+    void apply_modifier(number_t action_time, frame_attribute_layer &attributes, const frame_attribute_stack &ref_attributes) const;
 
     [[nodiscard]] std::string get_locator() const noexcept override;
 
+    // Script name that selects the built-in interpolation instead of a Lua script. It reads the params
+    // "to" (required), "from" (defaults to the incoming value) and "easing" (a curve name, defaults to linear).
+    constexpr static text_t NATIVE_LERP_NAME = "camellia.lerp";
+    constexpr static text_t FROM_NAME = "from";
+    constexpr static text_t TO_NAME = "to";
+    constexpr static text_t EASING_NAME = "easing";
+
     variant final_value;
 
 private:
@@ -86,9 +93,19 @@ private:
 
     action_timeline *_p_timeline{nullptr};
     scripting_helper::scripting_engine *_p_script{nullptr};
+    // Slot of the modified attribute in the timeline's layout, resolved once in init()
+    const attribute_layout *_p_layout{nullptr};
+    attribute_layout::slot_t _attribute_slot{attribute_layout::INVALID_SLOT};
     std::map<text_t, hash_t> _ref_params;
 
-    [[nodiscard]] variant modify(number_t action_time, const variant &base_value, std::vector<std::map<hash_t, variant>> &attributes) const;
+    // Built-in modifiers run without a scripting engine and keep their literal params here
+    boolean_t _is_native{false};
+    algorithm_helper::easing_types _easing{algorithm_helper::EASE_LINEAR};
+    std::map<text_t, variant> _native_params;
+
+    [[nodiscard]] variant modify(number_t action_time, const variant &base_value, const frame_attribute_stack &attributes) const;
+    [[nodiscard]] variant modify_native(number_t action_time, const variant &base_value, const frame_attribute_stack &attributes) const;
+    [[nodiscard]] static const variant *find_ref_attribute(hash_t h_attribute_name, const frame_attribute_stack &attributes);
 };
 
 class composite_action : public action {
@@ -83,6 +83,7 @@ void action_timeline_keyframe::init(const std::shared_ptr<action_timeline_keyfra
 }
 
 void action_timeline_keyframe::fina() {
+    get_manager().resolve_log_locators();
     _state = state::UNINITIALIZED;
     _error_message.clear();
     _data = nullptr;
@@ -105,7 +106,7 @@ stage *action_timeline::get_stage() const { return _p_stage; }
 
 number_t action_timeline::get_effective_duration() const { return _effective_duration; }
 
-void action_timeline::init(const std::vector<std::shared_ptr<action_timeline_data>> &data, stage &stage, node *p_parent) {
+void action_timeline::init(const std::vector<std::shared_ptr<action_timeline_data>> &data, stage &stage, node *p_parent, const attribute_layout *p_layout) {
     for (size_t i = 0; i < data.size(); i++) {
         REQUIRES_VALID_MSG(*data[i], std::format("Action timeline data #{} is invalid", i));
     }
@@ -113,6 +114,8 @@ void action_timeline::init(const std::vector<std::shared_ptr<action_timeline_dat
     _data = data;
     _p_stage = &stage;
     _p_parent = p_parent;
+    // Set before the keyframes are created, their modifiers resolve slots against it
+    _p_layout = p_layout;
 
     int track_index = 0;
     for (const auto &d : data) {
@@ -144,11 +147,13 @@ void action_timeline::init(const std::vector<std::shared_ptr<action_timeline_dat
 }
 
 void action_timeline::fina() {
+    get_manager().resolve_log_locators();
     _state = state::UNINITIALIZED;
     _error_message.clear();
     _data.clear();
     _p_stage = nullptr;
     _p_parent = nullptr;
+    _p_layout = nullptr;
     _effective_duration = 0.0F;
 
     for (auto &track : _tracks) {
@@ -176,10 +181,9 @@ std::vector<const action_timeline_keyframe *> action_timeline::sample(number_t t
     return res;
 }
 
-std::map<hash_t, variant> action_timeline::update(const number_t timeline_time, const std::map<hash_t, variant> &attributes,
-                                                  std::vector<std::map<hash_t, variant>> &ref_attributes, const boolean_t continuous,
-                                                  const boolean_t exclude_ongoing) {
-    REQUIRES_READY_RETURN(*this, (std::map<hash_t, variant>()));
+void action_timeline::update(const number_t timeline_time, frame_attribute_layer &attributes, frame_attribute_stack &ref_attributes,
+                             const boolean_t continuous, const boolean_t exclude_ongoing) {
+    REQUIRES_READY(*this);
     resource_helper::finally fin([this]() { _current_initial_attributes = nullptr; });
 
     _current_initial_attributes = &attributes;
@@ -224,8 +228,6 @@ std::map<hash_t, variant> action_timeline::update(const number_t timeline_time,
         }
     }
 
-    std::map<hash_t, variant> temp_attributes{attributes};
-
     for (const auto *keyframe : finishing_keyframes) {
         // Skip if keyframe is in failed state
         if (keyframe->has_error()) {
@@ -240,7 +242,7 @@ std::map<hash_t, variant> action_timeline::update(const number_t timeline_time,
             auto *ca = dynamic_cast<composite_action *>(action);
             auto *timeline = ca->get_timeline();
             if (timeline != nullptr) {
-                temp_attributes = timeline->update(keyframe->get_preferred_duration(), temp_attributes, ref_attributes, continuous, true);
+                timeline->update(keyframe->get_preferred_duration(), attributes, ref_attributes, continuous, true);
             }
             break;
         }
@@ -263,14 +265,14 @@ std::map<hash_t, variant> action_timeline::update(const number_t timeline_time,
         switch (action->get_action_type()) {
         case action_data::action_types::ACTION_MODIFIER: {
             auto *ma = dynamic_cast<modifier_action *>(action);
-            ma->apply_modifier(action_time, temp_attributes, ref_attributes);
+            ma->apply_modifier(action_time, attributes, ref_attributes);
             break;
         }
         case action_data::action_types::ACTION_COMPOSITE: {
             auto *ca = dynamic_cast<composite_action *>(action);
             auto *timeline = ca->get_timeline();
             if (timeline != nullptr) {
-                temp_attributes = timeline->update(action_time, temp_attributes, ref_attributes, continuous, false);
+                timeline->update(action_time, attributes, ref_attributes, continuous, false);
             }
             break;
         }
@@ -279,8 +281,6 @@ std::map<hash_t, variant> action_timeline::update(const number_t timeline_time,
         }
         }
     }
-
-    return temp_attributes;
 }
 
 std::string action_timeline::get_locator() const noexcept {
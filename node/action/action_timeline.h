@@ -75,15 +75,18 @@ public:
 
     [[nodiscard]] number_t get_effective_duration() const;
 
-    void init(const std::vector<std::shared_ptr<action_timeline_data>> &data, stage &stage, node *p_parent);
+    // p_layout is the attribute layout of the actor the timeline animates, nullptr if it has none
+    void init(const std::vector<std::shared_ptr<action_timeline_data>> &data, stage &stage, node *p_parent, const attribute_layout *p_layout);
+
+    [[nodiscard]] const attribute_layout *get_attribute_layout() const { return _p_layout; }
 
     void fina();
 
     [[nodiscard]] std::vector<const action_timeline_keyframe *> sample(number_t timeline_time) const;
 
-    [[nodiscard]] std::map<hash_t, variant> update(number_t timeline_time, const std::map<hash_t, variant> &attributes,
-                                                   std::vector<std::map<hash_t, variant>> &ref_attributes, boolean_t continuous = true,
-                                                   boolean_t exclude_ongoing = false);
+    // Applies the actions at timeline_time to attributes in place
+    void update(number_t timeline_time, frame_attribute_layer &attributes, frame_attribute_stack &ref_attributes, boolean_t continuous = true,
+                boolean_t exclude_ongoing = false);
 
     [[nodiscard]] std::string get_locator() const noexcept override;
 
@@ -94,9 +97,10 @@ private:
     number_t _effective_duration{0.0F};
     std::vector<integer_t> _last_completed_keyframe_indices;
     std::vector<std::vector<std::unique_ptr<action_timeline_keyframe>>> _tracks;
-    const std::map<hash_t, variant> *_current_initial_attributes{nullptr};
+    const frame_attribute_layer *_current_initial_attributes{nullptr};
 
     stage *_p_stage{nullptr};
+    const attribute_layout *_p_layout{nullptr};
 };
 
 } // namespace camellia
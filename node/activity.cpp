@@ -33,6 +33,16 @@ void activity::init(const std::shared_ptr<activity_data> &data, boolean_t keep_a
         _initial_attributes[attribute.first] = attribute.second;
     }
 
+    _p_layout = sta.get_attribute_layout(actor_data->h_actor_type);
+    _initial_slots.clear();
+    if (_p_layout != nullptr) {
+        _initial_slots.reserve(_p_layout->get_size());
+        for (const auto h_key : _p_layout->get_keys()) {
+            const auto it = _initial_attributes.find(h_key);
+            _initial_slots.push_back(it != _initial_attributes.end() ? &it->second : nullptr);
+        }
+    }
+
     actor *p_actor{nullptr};
     if (!keep_actor) {
         auto *parent_activity = static_cast<actor *>(_p_parent)->get_parent_activity();
@@ -45,12 +55,13 @@ void activity::init(const std::shared_ptr<activity_data> &data, boolean_t keep_a
 
     const auto *actor_data_ptr = p_actor->get_data();
     REQUIRES_NOT_NULL_MSG(actor_data_ptr, "Actor data is nullptr.");
-    _p_timeline->init({(*actor_data_ptr)->timeline, data->timeline}, *_p_stage, this);
+    _p_timeline->init({(*actor_data_ptr)->timeline, data->timeline}, *_p_stage, this, _p_layout.get());
 
     _state = state::READY;
 }
 
 void activity::fina(boolean_t keep_actor) {
+    get_manager().resolve_log_locators();
     _state = state::UNINITIALIZED;
     _error_message.clear();
 
@@ -65,38 +76,59 @@ void activity::fina(boolean_t keep_actor) {
     _p_timeline->fina();
 
     _initial_attributes.clear();
+    _initial_slots.clear();
+    _p_layout = nullptr;
     _p_stage = nullptr;
     _p_data = nullptr;
 }
 
-number_t activity::update(number_t beat_time, std::vector<std::map<hash_t, variant>> &parent_attributes) {
+number_t activity::update(number_t beat_time, frame_attribute_stack &parent_attributes) {
     REQUIRES_READY_RETURN(*this, 0.0F);
     REQUIRES_NOT_NULL_RETURN(_p_stage, 0.0F);
 
     auto *p_actor = _p_stage->get_actor(_aid);
     REQUIRES_NOT_NULL_RETURN(p_actor, 0.0F);
 
-    auto updated = _p_timeline->update(beat_time, _initial_attributes, parent_attributes);
+    // Initial values are read in place, only what the timeline writes this frame goes into the arena
+    frame_attribute_layer updated(_initial_attributes, _p_layout.get(), _initial_slots, parent_attributes.get_allocator().resource());
+    _p_timeline->update(beat_time, updated, parent_attributes);
 
+    // Child actors read this frame's attributes from the parent stack, leaf actors can hand the written values over
+    const auto has_children = p_actor->has_children();
     auto *attributes = p_actor->get_attributes();
     if (attributes != nullptr) {
-        attributes->update(updated);
+        const auto suppressed_before = attributes->get_suppressed_change_count();
+        if (has_children) {
+            attributes->update(updated);
+        } else {
+            attributes->update(std::move(updated));
+        }
+        attributes->record_history(_p_stage->get_stage_time());
         const auto &dirty = attributes->peek_dirty_attributes();
 
         // If dirty values exist, notify the event
         if (!dirty.empty()) {
-            node_attribute_dirty_event::dirty_attributes_vector dirty_attribute_pairs;
+            const auto &p_values = get_manager().get_attribute_value_log();
+            node_attribute_dirty_event::dirty_attributes_vector dirty_attribute_pairs(get_manager().get_event_resource());
             dirty_attribute_pairs.reserve(dirty.size());
             for (const auto &h_key : dirty) {
-                dirty_attribute_pairs.emplace_back(h_key, attributes->get(h_key));
+                const auto *p_value = attributes->get(h_key);
+                dirty_attribute_pairs.emplace_back(h_key, p_value != nullptr ? p_values->append(*p_value) : nullptr);
             }
-            get_manager().enqueue_event<node_attribute_dirty_event>(*p_actor, std::move(dirty_attribute_pairs));
+            get_manager().enqueue_event<node_attribute_dirty_event>(*p_actor, std::move(dirty_attribute_pairs), p_values);
             attributes->clear_dirty_attributes();
+        } else if (attributes->get_suppressed_change_count() != suppressed_before) {
+            get_manager().count_suppressed_dirty_event();
         }
     }
 
-    parent_attributes.push_back(updated);
-    auto res = std::max(p_actor->update_children(beat_time, parent_attributes), _p_timeline->get_effective_duration() - beat_time);
+    const auto time_to_end = _p_timeline->get_effective_duration() - beat_time;
+    if (!has_children) {
+        return std::max(0.0F, time_to_end);
+    }
+
+    parent_attributes.push_back(std::move(updated));
+    auto res = std::max(p_actor->update_children(beat_time, parent_attributes), time_to_end);
     parent_attributes.pop_back();
     return res;
 }
@@ -8,6 +8,7 @@
 #include "data/stage_data.h"
 #include <map>
 #include <memory>
+#include <vector>
 
 namespace camellia {
 
@@ -26,7 +27,7 @@ public:
     [[nodiscard]] stage *get_stage() const;
     void init(const std::shared_ptr<activity_data> &data, boolean_t keep_actor, stage &sta, node *p_parent);
     void fina(boolean_t keep_actor);
-    number_t update(number_t beat_time, std::vector<std::map<hash_t, variant>> &parent_attributes);
+    number_t update(number_t beat_time, frame_attribute_stack &parent_attributes);
     [[nodiscard]] const std::map<hash_t, variant> *get_initial_values();
 
     [[nodiscard]] std::string get_locator() const noexcept override;
@@ -36,6 +37,9 @@ public:
 private:
     std::shared_ptr<activity_data> _p_data{nullptr};
     std::map<hash_t, variant> _initial_attributes;
+    // The actor type's layout and, per slot, the initial value in _initial_attributes (nullptr if there is none)
+    std::shared_ptr<const attribute_layout> _p_layout;
+    std::vector<const variant *> _initial_slots;
     stage *_p_stage{nullptr};
     std::unique_ptr<action_timeline> _p_timeline{get_manager().new_live_object<action_timeline>()};
     integer_t _aid{-1};
@@ -23,6 +23,11 @@ void actor::init(const std::shared_ptr<actor_data> &data, stage &sta, activity &
     _p_data = data;
     _p_stage = &sta;
     _p_parent = &parent;
+    _attributes.bind_layout(sta.get_attribute_layout(data->h_actor_type));
+    for (const auto &[h_attribute_name, tolerance] : get_manager().get_attribute_tolerances()) {
+        _attributes.set_tolerance(h_attribute_name, tolerance);
+    }
+    _attributes.enable_history(get_manager().get_attribute_history_capacity());
 
     const auto *initial_values = parent.get_initial_values();
     if (initial_values != nullptr) {
@@ -67,7 +72,7 @@ void actor::init(const std::shared_ptr<actor_data> &data, stage &sta, activity &
     get_manager().enqueue_event<node_init_event>(*this);
 }
 
-number_t actor::update_children(number_t beat_time, std::vector<std::map<hash_t, variant>> &parent_attributes) {
+number_t actor::update_children(number_t beat_time, frame_attribute_stack &parent_attributes) {
     REQUIRES_READY_RETURN(*this, 0.0F);
     number_t time_to_end = 0.0F;
     for (auto &child : _children) {
@@ -77,6 +82,7 @@ number_t actor::update_children(number_t beat_time, std::vector<std::map<hash_t,
 }
 
 void actor::fina(boolean_t keep_children) {
+    get_manager().resolve_log_locators();
     get_manager().enqueue_event<node_fina_event>(*this);
     _state = state::UNINITIALIZED;
     _error_message.clear();
@@ -98,6 +104,10 @@ activity *actor::get_parent_activity() const {
 }
 
 std::string actor::get_locator() const noexcept {
-    return std::format("{} > Actor({})", _p_parent != nullptr ? _p_parent->get_locator() : "???", _p_data->h_actor_id);
+    const auto parent_locator = _p_parent != nullptr ? _p_parent->get_locator() : "???";
+    if (_p_data == nullptr) {
+        return std::format(R"({} > Actor(???))", parent_locator);
+    }
+    return std::format("{} > Actor({})", parent_locator, _p_data->h_actor_id);
 }
 } // namespace camellia
@@ -31,7 +31,8 @@ public:
     [[nodiscard]] const std::shared_ptr<actor_data> *get_data() const;
     void init(const std::shared_ptr<actor_data> &data, stage &sta, activity &parent);
     void fina(boolean_t keep_children);
-    number_t update_children(number_t beat_time, std::vector<std::map<hash_t, variant>> &parent_attributes);
+    number_t update_children(number_t beat_time, frame_attribute_stack &parent_attributes);
+    [[nodiscard]] boolean_t has_children() const { return !_children.empty(); }
 
     constexpr static text_t POSITION_NAME = "position";
     constexpr static text_t SCALE_NAME = "scale";
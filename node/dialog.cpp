@@ -19,6 +19,7 @@ void dialog::init(stage &st) {
 }
 
 void dialog::fina() {
+    get_manager().resolve_log_locators();
     get_manager().enqueue_event<node_fina_event>(*this);
     _state = state::UNINITIALIZED;
     _error_message.clear();
@@ -77,7 +78,7 @@ number_t dialog::update(number_t beat_time) {
         try {
             _p_transition_script->set_property("time", beat_time);
             const auto processed_text = _p_transition_script->guarded_invoke("run", 0, nullptr, variant::TEXT);
-            _attributes.set(algorithm_helper::calc_hash_const("text"), processed_text.get_text());
+            _attributes.set(algorithm_helper::calc_hash_const("text"), get_manager().get_string_interner().intern(processed_text.get_text()));
         } catch (scripting_helper::scripting_engine::scripting_engine_error &ex) {
             WARN_LOG(std::format("Error while invoking function 'run()' in transition script ({}) for text region:\n"
                                  "{}",
@@ -87,12 +88,14 @@ number_t dialog::update(number_t beat_time) {
 
     const auto &dirty = _attributes.peek_dirty_attributes();
     if (!dirty.empty()) {
-        node_attribute_dirty_event::dirty_attributes_vector dirty_attribute_pairs;
+        const auto &p_values = get_manager().get_attribute_value_log();
+        node_attribute_dirty_event::dirty_attributes_vector dirty_attribute_pairs(get_manager().get_event_resource());
         dirty_attribute_pairs.reserve(dirty.size());
         for (const auto &h_key : dirty) {
-            dirty_attribute_pairs.emplace_back(h_key, _attributes.get(h_key));
+            const auto *p_value = _attributes.get(h_key);
+            dirty_attribute_pairs.emplace_back(h_key, p_value != nullptr ? p_values->append(*p_value) : nullptr);
         }
-        get_manager().enqueue_event<node_attribute_dirty_event>(*this, std::move(dirty_attribute_pairs));
+        get_manager().enqueue_event<node_attribute_dirty_event>(*this, std::move(dirty_attribute_pairs), p_values);
         _attributes.clear_dirty_attributes();
     }
 
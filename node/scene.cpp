@@ -14,6 +14,7 @@ void scene::init(integer_t scene_id, stage &parent_stage) {
 }
 
 void scene::fina() {
+    get_manager().resolve_log_locators();
     get_manager().enqueue_event<node_fina_event>(*this);
     _state = state::UNINITIALIZED;
     _error_message.clear();
@@ -110,7 +111,7 @@ number_t scene::update(number_t stage_time) {
     time_to_end = std::max(main_dialog->update(beat_time), time_to_end);
 
     // Update all activities and find the maximum time to end
-    std::vector<std::map<hash_t, variant>> parent_attributes;
+    frame_attribute_stack parent_attributes(&get_manager().get_frame_arena());
     for (auto &activity_pair : _activities) {
         time_to_end = std::max(activity_pair.second->update(beat_time, parent_attributes), time_to_end);
     }
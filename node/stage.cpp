@@ -73,6 +73,7 @@ void stage::init(const std::shared_ptr<stage_data> &data, manager &parent) {
     REQUIRES_VALID(*data);
 
     _p_scenario = data;
+    _p_attribute_layouts = parent.get_attribute_layouts(data->h_stage_name);
 
     _scenes.emplace_back(parent.new_live_object<scene>());
     _scenes.back()->init(_next_scene_id++, *this);
@@ -84,6 +85,7 @@ void stage::init(const std::shared_ptr<stage_data> &data, manager &parent) {
 }
 
 void stage::fina() {
+    get_manager().resolve_log_locators();
     get_manager().enqueue_event<node_fina_event>(*this);
     _state = state::UNINITIALIZED;
     _error_message.clear();
@@ -96,6 +98,7 @@ void stage::fina() {
     _scenes.clear();
 
     _p_scenario = nullptr;
+    _p_attribute_layouts = nullptr;
     _next_beat_index = 0;
     _next_scene_id = 0;
 
@@ -109,8 +112,14 @@ number_t stage::update(const number_t stage_time) {
     REQUIRES_NOT_NULL_RETURN(main_dialog, 0.0F);
 
     _stage_time = stage_time;
+    get_manager().get_frame_arena().reset();
 
     _time_to_end = _scenes.back()->update(stage_time);
+    get_manager().flush_event_overflow();
+    // The ring's consumer may still be reading this frame's values
+    if (get_manager().get_event_ring() != nullptr) {
+        get_manager().release_attribute_value_log();
+    }
     return _time_to_end;
 }
 
@@ -125,6 +134,14 @@ std::shared_ptr<text_style_data> stage::get_default_text_style() const {
     return _p_scenario->default_text_style;
 }
 
+std::shared_ptr<const attribute_layout> stage::get_attribute_layout(const hash_t h_actor_type) const {
+    if (_p_attribute_layouts == nullptr) {
+        return nullptr;
+    }
+    const auto it = _p_attribute_layouts->find(h_actor_type);
+    return it == _p_attribute_layouts->end() ? nullptr : it->second;
+}
+
 std::string stage::get_locator() const noexcept {
     if (_p_scenario == nullptr) {
         return std::format(R"({} > Stage(???))", get_manager().get_locator());
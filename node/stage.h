@@ -3,6 +3,7 @@
 
 #include "activity.h"
 #include "actor.h"
+#include "attribute_layout.h"
 #include "attribute_registry.h"
 #include "camellia_macro.h"
 #include "camellia_typedef.h"
@@ -39,6 +40,7 @@ public:
     virtual number_t update(number_t stage_time);
 
     [[nodiscard]] number_t get_time_to_end() const { return _time_to_end; }
+    [[nodiscard]] number_t get_stage_time() const { return _stage_time; }
 
     [[nodiscard]] std::string get_locator() const noexcept override;
 
@@ -49,9 +51,12 @@ public:
     [[nodiscard]] std::shared_ptr<action_data> get_action_data(hash_t h_id) const;
     [[nodiscard]] const std::string *get_script_code(hash_t h_script_name) const;
     [[nodiscard]] std::shared_ptr<text_style_data> get_default_text_style() const;
+    // From the layouts compiled when the stage data was registered, nullptr for unknown actor types or unregistered data
+    [[nodiscard]] std::shared_ptr<const attribute_layout> get_attribute_layout(hash_t h_actor_type) const;
 
 private:
     std::shared_ptr<stage_data> _p_scenario;
+    std::shared_ptr<const attribute_layout_map> _p_attribute_layouts;
     integer_t _next_beat_index{0};
     integer_t _next_scene_id{0};
 
@@ -0,0 +1,92 @@
+#ifndef CAMELLIA_SPSC_RING_H
+#define CAMELLIA_SPSC_RING_H
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <memory>
+#include <utility>
+
+namespace camellia {
+
+// Bounded lock-free queue for exactly one producer thread and one consumer thread. Each side keeps a cached copy of
+// the other side's index and only reloads it when the ring looks full or empty, so the shared cache lines are touched
+// once per batch rather than once per element.
+template <typename T> class spsc_ring {
+public:
+    constexpr static size_t CACHE_LINE_SIZE = 64;
+
+    // Capacity is rounded up to a power of two
+    explicit spsc_ring(size_t capacity)
+        : _capacity(std::bit_ceil(std::max<size_t>(capacity, 2))), _mask(_capacity - 1), _p_slots(std::make_unique<T[]>(_capacity)) {}
+    spsc_ring(const spsc_ring &) = delete;
+    spsc_ring &operator=(const spsc_ring &) = delete;
+    spsc_ring(spsc_ring &&) = delete;
+    spsc_ring &operator=(spsc_ring &&) = delete;
+    ~spsc_ring() = default;
+
+    // Producer side. Leaves value untouched and returns false if the ring is full.
+    bool try_push(T &&value) {
+        const auto tail = _tail.load(std::memory_order_relaxed);
+        if (tail - _cached_head == _capacity) {
+            _cached_head = _head.load(std::memory_order_acquire);
+            if (tail - _cached_head == _capacity) {
+                return false;
+            }
+        }
+        _p_slots[tail & _mask] = std::move(value);
+        _tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side. Returns false if the ring is empty.
+    bool try_pop(T &value) {
+        const auto head = _head.load(std::memory_order_relaxed);
+        if (head == _cached_tail) {
+            _cached_tail = _tail.load(std::memory_order_acquire);
+            if (head == _cached_tail) {
+                return false;
+            }
+        }
+        auto &slot = _p_slots[head & _mask];
+        value = std::move(slot);
+        slot = T();
+        _head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side. Passes every element available right now to f as an rvalue and frees their slots at once.
+    template <typename F> size_t drain(F &&f) {
+        const auto head = _head.load(std::memory_order_relaxed);
+        _cached_tail = _tail.load(std::memory_order_acquire);
+        for (auto i = head; i != _cached_tail; i++) {
+            auto &slot = _p_slots[i & _mask];
+            f(std::move(slot));
+            slot = T();
+        }
+        _head.store(_cached_tail, std::memory_order_release);
+        return _cached_tail - head;
+    }
+
+    [[nodiscard]] size_t get_capacity() const noexcept { return _capacity; }
+    // Exact only when neither side is running
+    [[nodiscard]] size_t get_size() const noexcept { return _tail.load(std::memory_order_acquire) - _head.load(std::memory_order_acquire); }
+
+private:
+    const size_t _capacity;
+    const size_t _mask;
+    std::unique_ptr<T[]> _p_slots;
+
+    // Written by the consumer
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> _head{0};
+    size_t _cached_tail{0};
+
+    // Written by the producer
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> _tail{0};
+    size_t _cached_head{0};
+};
+
+} // namespace camellia
+
+#endif // CAMELLIA_SPSC_RING_H
@@ -0,0 +1,44 @@
+#include "string_interner.h"
+#include "helper/algorithm_helper.h"
+#include <algorithm>
+
+namespace camellia {
+
+variant string_interner::intern(std::string_view text) {
+    const auto h_text = algorithm_helper::calc_hash(text);
+    auto [begin, end] = _entries.equal_range(h_text);
+    for (auto it = begin; it != end; ++it) {
+        if (it->second.get_text() == text) {
+            return it->second;
+        }
+    }
+
+    if (_entries.size() >= _sweep_threshold) {
+        sweep();
+        _sweep_threshold = std::max(INITIAL_SWEEP_THRESHOLD, _entries.size() * 2);
+    }
+
+    auto *p_payload = new variant::payload<text_t>(text);
+    p_payload->p_interner = this;
+    p_payload->h_text = h_text;
+
+    variant v;
+    v._type = variant::TEXT;
+    v._data.p_payload = p_payload;
+    return _entries.emplace(h_text, std::move(v))->second;
+}
+
+size_t string_interner::sweep() {
+    return std::erase_if(_entries, [](const auto &entry) { return entry.second._data.p_payload->ref_count.load(std::memory_order_acquire) == 1; });
+}
+
+size_t string_interner::get_count() const { return _entries.size(); }
+
+string_interner::~string_interner() {
+    // Surviving payloads turn into plain text so they never compare against a dead interner
+    for (auto &[h_text, v] : _entries) {
+        v._data.p_payload->p_interner = nullptr;
+    }
+}
+
+} // namespace camellia
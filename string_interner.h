@@ -0,0 +1,36 @@
+#ifndef CAMELLIA_STRING_INTERNER_H
+#define CAMELLIA_STRING_INTERNER_H
+
+#include "camellia_typedef.h"
+#include "variant.h"
+#include <string_view>
+#include <unordered_map>
+
+namespace camellia {
+
+// Deduplicates text values. Variants returned by intern() share one payload per distinct string and carry its
+// precomputed hash, so comparing or hashing them never touches the characters.
+class string_interner {
+public:
+    [[nodiscard]] variant intern(std::string_view text);
+    // Drops strings that are no longer referenced outside the interner, returns how many were dropped
+    size_t sweep();
+    [[nodiscard]] size_t get_count() const;
+
+    string_interner() = default;
+    ~string_interner();
+    string_interner(const string_interner &) = delete;
+    string_interner &operator=(const string_interner &) = delete;
+    string_interner(string_interner &&) = delete;
+    string_interner &operator=(string_interner &&) = delete;
+
+private:
+    static constexpr size_t INITIAL_SWEEP_THRESHOLD = 256;
+
+    std::unordered_multimap<hash_t, variant> _entries;
+    size_t _sweep_threshold{INITIAL_SWEEP_THRESHOLD};
+};
+
+} // namespace camellia
+
+#endif // CAMELLIA_STRING_INTERNER_H
@@ -1,6 +1,8 @@
 #include <flatbuffers/flatbuffer_builder.h>
 #include <flatbuffers/flatbuffers.h>
 #include <gtest/gtest.h>
+#include <format>
+#include <map>
 #include <memory>
 #include <vector>
 
@@ -12,6 +14,7 @@
 #include "message_generated.h"
 #include "node/actor.h"
 #include "variant.h"
+#include "variant_view.h"
 
 using namespace camellia;
 
@@ -254,6 +257,227 @@ TEST_F(serialization_test, VariantFlatBuffersRoundtrip_ComplexTypes) {
     _builder->Clear();
 }
 
+TEST_F(serialization_test, VariantView_ReadsInPlace) {
+    // Views read straight out of the buffer without materializing a variant
+    std::map<variant, variant> inner_dict = {{variant("inner_key"), variant(vector3(1.0F, 2.0F, 3.0F))}};
+    std::vector<variant> test_array = {variant(7), variant("seven"), variant(bytes_t{1, 2, 3}), variant(inner_dict)};
+    std::map<variant, variant> test_dict = {{variant("array"), variant(test_array)}, {variant(2), variant(2.5)}, {variant("flag"), variant(true)}};
+    variant test_var(test_dict);
+    _builder->Finish(test_var.to_flatbuffers(*_builder));
+
+    variant_view view(fb::GetVariant(_builder->GetBufferPointer()));
+    EXPECT_EQ(view.get_value_type(), variant::DICTIONARY);
+    EXPECT_TRUE(view == test_var);
+    EXPECT_EQ(view.to_variant(), test_var);
+
+    auto dict = view.get_dictionary();
+    EXPECT_EQ(dict.size(), 3);
+    EXPECT_EQ((number_t)dict.find(variant(2)), 2.5);
+    EXPECT_TRUE((boolean_t)dict.find(variant("flag")));
+    EXPECT_EQ(dict.find(variant("missing")).get_value_type(), variant::VOID);
+
+    auto arr = dict.find(variant("array")).get_array();
+    ASSERT_EQ(arr.size(), 4);
+    EXPECT_EQ((integer_t)arr[0], 7);
+    EXPECT_EQ(arr[1].get_text(), "seven");
+    auto bytes = arr[2].get_bytes();
+    EXPECT_EQ(bytes_t(bytes.begin(), bytes.end()), bytes_t({1, 2, 3}));
+    EXPECT_EQ(arr[3].get_dictionary().find(variant("inner_key")).get_vector3(), vector3(1.0F, 2.0F, 3.0F));
+    EXPECT_THROW((void)arr[1].get_vector3(), std::bad_variant_access);
+
+    EXPECT_FALSE(view == variant(test_array));
+    EXPECT_EQ(variant_view(nullptr).get_value_type(), variant::VOID);
+}
+
+TEST_F(serialization_test, VariantView_DictionaryLookup) {
+    // Keys of every kind, encoded in variant order, are found by binary search
+    std::map<variant, variant> test_dict;
+    for (integer_t i = 0; i < 64; i++) {
+        test_dict[variant(i)] = variant(i * 2);
+        test_dict[variant(std::format("key_{}", i))] = variant(i);
+        test_dict[variant(vector2(static_cast<number_t>(i), 0.0F))] = variant(true);
+    }
+    test_dict[variant(hash_t(0xABCDULL))] = variant("hash");
+    test_dict[variant(bytes_t{1, 2, 3})] = variant("bytes");
+    variant test_var(test_dict);
+    _builder->Finish(test_var.to_flatbuffers(*_builder));
+
+    variant_view view(fb::GetVariant(_builder->GetBufferPointer()));
+    auto dict = view.get_dictionary();
+    for (const auto &[key, value] : test_dict) {
+        EXPECT_TRUE(dict.find(key) == value) << key.to_desc();
+        EXPECT_EQ(view.get_dictionary().find(key).compare(value), 0);
+    }
+    EXPECT_EQ(dict.find(variant(64)).get_value_type(), variant::VOID);
+    EXPECT_EQ(dict.find(variant("key_64")).get_value_type(), variant::VOID);
+    EXPECT_EQ(dict.find(variant(bytes_t{1, 2})).get_value_type(), variant::VOID);
+    EXPECT_TRUE(view == test_var);
+
+    auto changed = test_dict;
+    changed[variant("key_3")] = variant(4);
+    EXPECT_FALSE(view == variant(changed));
+}
+
+TEST_F(serialization_test, VariantView_UnsortedDictionary) {
+    // Pairs written by another tool in descending key order
+    std::vector<flatbuffers::Offset<fb::VariantKeyValuePair>> pairs;
+    for (integer_t i = 7; i >= 0; i--) {
+        const auto key_offset = variant(i).to_flatbuffers(*_builder);
+        const auto value_offset = variant(i * 10).to_flatbuffers(*_builder);
+        pairs.push_back(fb::CreateVariantKeyValuePair(*_builder, key_offset, value_offset));
+    }
+    const auto data_offset = fb::CreateVariantDictionaryValue(*_builder, _builder->CreateVector(pairs)).o;
+    _builder->Finish(fb::CreateVariant(*_builder, fb::VariantData_dictionary_value, data_offset));
+
+    variant_view view(fb::GetVariant(_builder->GetBufferPointer()));
+    auto dict = view.get_dictionary();
+    EXPECT_FALSE(dict.is_sorted());
+    for (integer_t i = 0; i < 8; i++) {
+        EXPECT_TRUE(dict.find(variant(i)) == variant(i * 10)) << i;
+    }
+    EXPECT_EQ(dict.find(variant(8)).get_value_type(), variant::VOID);
+
+    std::map<variant, variant> expected;
+    for (integer_t i = 0; i < 8; i++) {
+        expected[variant(i)] = variant(i * 10);
+    }
+    EXPECT_TRUE(view == variant(expected));
+    EXPECT_EQ(view.to_variant(), variant(expected));
+}
+
+TEST_F(serialization_test, VariantFlatBuffers_ReadsLegacyTableLayout) {
+    // Buffers written before fixed-size kinds became structs still decode
+    std::vector<std::pair<flatbuffers::Offset<fb::Variant>, variant>> legacy;
+    legacy.emplace_back(fb::CreateVariant(*_builder, fb::VariantData_integer_value, fb::CreateInt32Value(*_builder, -7).o), variant(-7));
+    legacy.emplace_back(fb::CreateVariant(*_builder, fb::VariantData_number_value, fb::CreateFloatValue(*_builder, 0.5F).o), variant(0.5F));
+    legacy.emplace_back(fb::CreateVariant(*_builder, fb::VariantData_boolean_value, fb::CreateBoolValue(*_builder, true).o), variant(true));
+    legacy.emplace_back(fb::CreateVariant(*_builder, fb::VariantData_vector2_value, fb::CreateVector2(*_builder, 1.0F, 2.0F).o),
+                        variant(vector2(1.0F, 2.0F)));
+    legacy.emplace_back(fb::CreateVariant(*_builder, fb::VariantData_vector3_value, fb::CreateVector3(*_builder, 1.0F, 2.0F, 3.0F).o),
+                        variant(vector3(1.0F, 2.0F, 3.0F)));
+    legacy.emplace_back(fb::CreateVariant(*_builder, fb::VariantData_vector4_value, fb::CreateVector4(*_builder, 1.0F, 2.0F, 3.0F, 4.0F).o),
+                        variant(vector4(1.0F, 2.0F, 3.0F, 4.0F)));
+    legacy.emplace_back(fb::CreateVariant(*_builder, fb::VariantData_hash_value, fb::CreateUInt64Value(*_builder, 0xABCDULL).o), variant(hash_t(0xABCDULL)));
+
+    std::vector<flatbuffers::Offset<fb::Variant>> offsets;
+    std::vector<variant> expected;
+    for (const auto &[offset, value] : legacy) {
+        offsets.push_back(offset);
+        expected.push_back(value);
+    }
+    auto array_offset = fb::CreateVariant(*_builder, fb::VariantData_array_value, fb::CreateVariantVectorValue(*_builder, _builder->CreateVector(offsets)).o);
+    _builder->Finish(array_offset);
+
+    auto verifier = flatbuffers::Verifier(_builder->GetBufferPointer(), _builder->GetSize());
+    EXPECT_TRUE(fb::VerifyVariantBuffer(verifier));
+    const auto *p_fb = fb::GetVariant(_builder->GetBufferPointer());
+    EXPECT_EQ(variant::from_flatbuffers(*p_fb), variant(expected));
+    EXPECT_TRUE(variant_view(p_fb) == variant(expected));
+
+    // the struct layout written today is smaller
+    const auto legacy_size = _builder->GetSize();
+    _builder->Clear();
+    _builder->Finish(variant(expected).to_flatbuffers(*_builder));
+    EXPECT_LT(_builder->GetSize(), legacy_size);
+    EXPECT_EQ(fb::GetVariant(_builder->GetBufferPointer())->data_as_array_value()->value()->Get(4)->data_type(), fb::VariantData_vector3_struct);
+}
+
+// ============================================================================
+// VARIANT BINARY SERIALIZATION TESTS
+// ============================================================================
+
+TEST_F(serialization_test, VariantBinaryRoundtrip_AllTypes) {
+    std::map<variant, variant> inner_dict = {{variant("inner_key"), variant(vector3(1.0F, 2.0F, 3.0F))}};
+    std::vector<variant> test_array = {variant(7), variant("seven"), variant(bytes_t{1, 2, 3}), variant(inner_dict)};
+    std::vector<variant> values = {variant(),
+                                   variant(-42),
+                                   variant(0.1F),
+                                   variant(true),
+                                   variant("text"),
+                                   variant("failed", true),
+                                   variant(vector2(1.0F, -2.0F)),
+                                   variant(vector3(0.1F, 0.2F, 0.3F)),
+                                   variant(vector4(1.0F, 2.0F, 3.0F, 4.0F)),
+                                   variant(bytes_t{0x00, 0xFF, 0x7F}),
+                                   variant(test_array),
+                                   variant(std::map<variant, variant>{{variant("array"), variant(test_array)}, {variant(2), variant(2.5F)}}),
+                                   variant(hash_t(0x123456789ABCDEF0))};
+
+    bytes_t stream;
+    for (const auto &v : values) {
+        auto encoded = v.to_binary();
+        EXPECT_EQ(variant::from_binary(encoded), v);
+        stream.insert(stream.end(), encoded.begin(), encoded.end());
+    }
+
+    // values can be read back to back from one buffer
+    size_t offset = 0;
+    for (const auto &v : values) {
+        EXPECT_EQ(variant::from_binary(stream, offset), v);
+    }
+    EXPECT_EQ(offset, stream.size());
+
+    // numbers are bit-exact, unlike descriptors
+    EXPECT_EQ((number_t)variant::from_binary(variant(0.1F).to_binary()), 0.1F);
+
+    // scalars fit in 5 bytes
+    EXPECT_EQ(variant().to_binary().size(), 1);
+    EXPECT_EQ(variant(42).to_binary().size(), 5);
+    EXPECT_EQ(variant(4.2F).to_binary().size(), 5);
+    EXPECT_EQ(variant(true).to_binary().size(), 2);
+    // except hashes, which need all 64 bits
+    EXPECT_EQ(variant(hash_t(0x123456789ABCDEF0)).to_binary().size(), 9);
+}
+
+TEST_F(serialization_test, VariantBinary_RejectsMalformedInput) {
+    auto encoded = variant(std::vector<variant>{variant(1), variant("two")}).to_binary();
+
+    // every truncation fails as a whole and leaves the offset alone
+    for (size_t length = 0; length < encoded.size(); length++) {
+        bytes_t truncated(encoded.begin(), encoded.begin() + static_cast<std::ptrdiff_t>(length));
+        size_t offset = 0;
+        EXPECT_EQ(variant::from_binary(truncated, offset).get_value_type(), variant::VOID);
+        EXPECT_EQ(offset, 0);
+    }
+
+    // a length prefix larger than the buffer is not trusted
+    bytes_t huge_array = {static_cast<uint8_t>(variant::ARRAY), 0xFF, 0xFF, 0xFF, 0x7F};
+    EXPECT_EQ(variant::from_binary(huge_array).get_value_type(), variant::VOID);
+
+    bytes_t unknown_tag = {0x42};
+    EXPECT_EQ(variant::from_binary(unknown_tag).get_value_type(), variant::VOID);
+}
+
+TEST_F(serialization_test, VariantBinary_RejectsDeepNesting) {
+    // single-element arrays wrapped around a VOID leaf
+    auto nested = [](size_t depth) {
+        bytes_t data;
+        for (size_t i = 0; i < depth; i++) {
+            data.insert(data.end(), {static_cast<uint8_t>(variant::ARRAY), 0x01, 0x00, 0x00, 0x00});
+        }
+        data.push_back(static_cast<uint8_t>(variant::VOID));
+        return data;
+    };
+
+    auto at_limit = variant::from_binary(nested(variant::MAX_BINARY_DEPTH));
+    ASSERT_EQ(at_limit.get_value_type(), variant::ARRAY);
+
+    size_t offset = 0;
+    EXPECT_EQ(variant::from_binary(nested(variant::MAX_BINARY_DEPTH + 1), offset).get_value_type(), variant::VOID);
+    EXPECT_EQ(offset, 0);
+
+    // deep enough to overflow the stack without the limit
+    EXPECT_EQ(variant::from_binary(nested(1000000)).get_value_type(), variant::VOID);
+
+    // dictionary keys and values count towards the same depth
+    bytes_t dictionary_in_arrays = nested(variant::MAX_BINARY_DEPTH - 1);
+    dictionary_in_arrays.pop_back();
+    dictionary_in_arrays.insert(dictionary_in_arrays.end(), {static_cast<uint8_t>(variant::DICTIONARY), 0x01, 0x00, 0x00, 0x00});
+    dictionary_in_arrays.insert(dictionary_in_arrays.end(), {static_cast<uint8_t>(variant::INTEGER), 0x01, 0x00, 0x00, 0x00});
+    dictionary_in_arrays.insert(dictionary_in_arrays.end(), {static_cast<uint8_t>(variant::ARRAY), 0x00, 0x00, 0x00, 0x00});
+    EXPECT_EQ(variant::from_binary(dictionary_in_arrays).get_value_type(), variant::VOID);
+}
+
 // ============================================================================
 // MESSAGE FLATBUFFERS SERIALIZATION TESTS
 // ============================================================================
@@ -271,9 +495,9 @@ TEST_F(serialization_test, MessageFlatBuffersRoundtrip_NodeEvents) {
     _builder->Finish(event_offset);
 
     auto event_verifier = flatbuffers::Verifier(_builder->GetBufferPointer(), _builder->GetSize());
-    EXPECT_TRUE(fb::VerifyEventBuffer(event_verifier));
+    EXPECT_TRUE(event_verifier.VerifyBuffer<fb::Event>(nullptr));
 
-    const auto *event_fb = fb::GetEvent(_builder->GetBufferPointer());
+    const auto *event_fb = flatbuffers::GetRoot<fb::Event>(_builder->GetBufferPointer());
     EXPECT_EQ(event_fb->data_type(), fb::EventData_NodeInitEvent);
 
     const auto *init_fb = event_fb->data_as_NodeInitEvent();
@@ -292,9 +516,9 @@ TEST_F(serialization_test, MessageFlatBuffersRoundtrip_NodeEvents) {
     _builder->Finish(fina_event_offset);
 
     auto fina_event_verifier = flatbuffers::Verifier(_builder->GetBufferPointer(), _builder->GetSize());
-    EXPECT_TRUE(fb::VerifyEventBuffer(fina_event_verifier));
+    EXPECT_TRUE(fina_event_verifier.VerifyBuffer<fb::Event>(nullptr));
 
-    const auto *fina_event_fb = fb::GetEvent(_builder->GetBufferPointer());
+    const auto *fina_event_fb = flatbuffers::GetRoot<fb::Event>(_builder->GetBufferPointer());
     EXPECT_EQ(fina_event_fb->data_type(), fb::EventData_NodeFinaEvent);
 
     const auto *fina_fb = fina_event_fb->data_as_NodeFinaEvent();
@@ -311,9 +535,9 @@ TEST_F(serialization_test, MessageFlatBuffersRoundtrip_NodeEvents) {
     _builder->Finish(vis_event_offset);
 
     auto vis_event_verifier = flatbuffers::Verifier(_builder->GetBufferPointer(), _builder->GetSize());
-    EXPECT_TRUE(fb::VerifyEventBuffer(vis_event_verifier));
+    EXPECT_TRUE(vis_event_verifier.VerifyBuffer<fb::Event>(nullptr));
 
-    const auto *vis_event_fb = fb::GetEvent(_builder->GetBufferPointer());
+    const auto *vis_event_fb = flatbuffers::GetRoot<fb::Event>(_builder->GetBufferPointer());
     EXPECT_EQ(vis_event_fb->data_type(), fb::EventData_NodeVisibilityUpdateEvent);
 
     const auto *visibility_fb = vis_event_fb->data_as_NodeVisibilityUpdateEvent();
@@ -333,9 +557,9 @@ TEST_F(serialization_test, MessageFlatBuffersRoundtrip_NodeEvents) {
     _builder->Finish(attr_event_offset);
 
     auto attr_event_verifier = flatbuffers::Verifier(_builder->GetBufferPointer(), _builder->GetSize());
-    EXPECT_TRUE(fb::VerifyEventBuffer(attr_event_verifier));
+    EXPECT_TRUE(attr_event_verifier.VerifyBuffer<fb::Event>(nullptr));
 
-    const auto *attr_event_fb = fb::GetEvent(_builder->GetBufferPointer());
+    const auto *attr_event_fb = flatbuffers::GetRoot<fb::Event>(_builder->GetBufferPointer());
     EXPECT_EQ(attr_event_fb->data_type(), fb::EventData_NodeAttributeDirtyEvent);
 
     const auto *attr_fb = attr_event_fb->data_as_NodeAttributeDirtyEvent();
@@ -358,9 +582,9 @@ TEST_F(serialization_test, MessageFlatBuffersRoundtrip_LogEvent) {
     _builder->Finish(debug_event_offset);
 
     auto debug_event_verifier = flatbuffers::Verifier(_builder->GetBufferPointer(), _builder->GetSize());
-    EXPECT_TRUE(fb::VerifyEventBuffer(debug_event_verifier));
+    EXPECT_TRUE(debug_event_verifier.VerifyBuffer<fb::Event>(nullptr));
 
-    const auto *debug_event_fb = fb::GetEvent(_builder->GetBufferPointer());
+    const auto *debug_event_fb = flatbuffers::GetRoot<fb::Event>(_builder->GetBufferPointer());
     EXPECT_EQ(debug_event_fb->data_type(), fb::EventData_LogEvent);
 
     const auto *debug_fb = debug_event_fb->data_as_LogEvent();
@@ -378,9 +602,9 @@ TEST_F(serialization_test, MessageFlatBuffersRoundtrip_LogEvent) {
     _builder->Finish(error_event_offset);
 
     auto error_event_verifier = flatbuffers::Verifier(_builder->GetBufferPointer(), _builder->GetSize());
-    EXPECT_TRUE(fb::VerifyEventBuffer(error_event_verifier));
+    EXPECT_TRUE(error_event_verifier.VerifyBuffer<fb::Event>(nullptr));
 
-    const auto *error_event_fb = fb::GetEvent(_builder->GetBufferPointer());
+    const auto *error_event_fb = flatbuffers::GetRoot<fb::Event>(_builder->GetBufferPointer());
     EXPECT_EQ(error_event_fb->data_type(), fb::EventData_LogEvent);
 
     const auto *error_fb = error_event_fb->data_as_LogEvent();
@@ -390,6 +614,44 @@ TEST_F(serialization_test, MessageFlatBuffersRoundtrip_LogEvent) {
     _builder->Clear();
 }
 
+TEST_F(serialization_test, MessageFlatBuffersRoundtrip_EventBatch) {
+    auto test_node = _manager->new_live_object<actor>();
+    variant test_attr_value(42);
+    const auto test_attr_key = algorithm_helper::calc_hash("test_attribute");
+
+    _manager->enqueue_event<node_init_event>(*test_node);
+    node_attribute_dirty_event::dirty_attributes_vector dirty_attributes(_manager->get_event_resource());
+    dirty_attributes.emplace_back(test_attr_key, &test_attr_value);
+    _manager->enqueue_event<node_attribute_dirty_event>(*test_node, std::move(dirty_attributes));
+    _manager->log("Test log message", LOG_WARN);
+
+    EXPECT_EQ(_manager->flush_events(*_builder), 3);
+    EXPECT_TRUE(_manager->get_event_queue().empty());
+
+    auto verifier = flatbuffers::Verifier(_builder->GetBufferPointer(), _builder->GetSize());
+    EXPECT_TRUE(fb::VerifyEventBatchBuffer(verifier));
+
+    const auto *batch_fb = fb::GetEventBatch(_builder->GetBufferPointer());
+    ASSERT_EQ(batch_fb->events()->size(), 3);
+    EXPECT_EQ(batch_fb->events_type()->Get(0), fb::EventData_NodeInitEvent);
+    EXPECT_EQ(batch_fb->events_type()->Get(1), fb::EventData_NodeAttributeDirtyEvent);
+    EXPECT_EQ(batch_fb->events_type()->Get(2), fb::EventData_LogEvent);
+
+    const auto *init_fb = batch_fb->events()->GetAs<fb::NodeInitEvent>(0);
+    EXPECT_EQ(init_fb->base_node()->node_handle(), test_node->get_handle());
+    const auto *attr_fb = batch_fb->events()->GetAs<fb::NodeAttributeDirtyEvent>(1);
+    EXPECT_EQ(attr_fb->dirty_attributes()->Get(0)->attribute_key(), test_attr_key);
+    EXPECT_EQ(variant::from_flatbuffers(*attr_fb->dirty_attributes()->Get(0)->attribute_value()), test_attr_value);
+    const auto *log_fb = batch_fb->events()->GetAs<fb::LogEvent>(2);
+    EXPECT_EQ(log_fb->level(), fb::LogLevel_LOG_WARN);
+    EXPECT_EQ(log_fb->message()->str(), "Test log message");
+
+    // an empty queue still produces a valid batch
+    _builder->Clear();
+    EXPECT_EQ(_manager->flush_events(*_builder), 0);
+    EXPECT_EQ(fb::GetEventBatch(_builder->GetBufferPointer())->events()->size(), 0);
+}
+
 // ============================================================================
 // STAGE DATA FLATBUFFERS SERIALIZATION TESTS
 // ============================================================================
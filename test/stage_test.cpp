@@ -1,5 +1,7 @@
 #include <gtest/gtest.h>
 #include <memory>
+#include <string>
+#include <thread>
 #include <unordered_map>
 #include <vector>
 
@@ -7,6 +9,7 @@
 #include "helper/algorithm_helper.h"
 #include "manager.h"
 #include "message.h"
+#include "message_generated.h"
 #include "node/dialog.h"
 #include "node/stage.h"
 #include "variant.h"
@@ -531,3 +534,639 @@ end
 
     EXPECT_NO_THROW(_stage->fina());
 }
+
+TEST_F(stage_test, native_lerp_modifier) {
+    // a linear move that never touches the scripting engine: no script is registered for it
+    auto move_data = std::make_shared<modifier_action_data>();
+    move_data->h_action_name = algorithm_helper::calc_hash("native_move");
+    move_data->default_params[modifier_action::FROM_NAME] = variant(vector3(0.0F, 0.0F, 0.0F));
+    move_data->default_params[modifier_action::TO_NAME] = variant(vector3(1.0F, 2.0F, 3.0F));
+    move_data->default_params[modifier_action::EASING_NAME] = variant("linear");
+    move_data->h_attribute_name = algorithm_helper::calc_hash(actor::POSITION_NAME);
+    move_data->value_type = variant::VECTOR3;
+    move_data->h_script_name = algorithm_helper::calc_hash(modifier_action::NATIVE_LERP_NAME);
+
+    auto track = std::make_shared<action_timeline_track_data>();
+    track->keyframes = {
+        std::make_shared<action_timeline_keyframe_data>(
+            action_timeline_keyframe_data{.time = 0.0F, .preferred_duration_signed = -kTimelineDuration, .h_action_name = move_data->h_action_name}),
+    };
+
+    auto timeline = std::make_shared<action_timeline_data>();
+    timeline->effective_duration = kTimelineDuration;
+    timeline->tracks = {track};
+
+    auto actor_data_1 = std::make_shared<actor_data>();
+    actor_data_1->h_actor_type = algorithm_helper::calc_hash("test_actor_type_1");
+    actor_data_1->h_actor_id = algorithm_helper::calc_hash("test_actor_1");
+    actor_data_1->default_attributes[algorithm_helper::calc_hash(actor::POSITION_NAME)] = vector3(0.0F, 0.0F, 0.0F);
+    actor_data_1->timeline = std::make_shared<action_timeline_data>();
+
+    auto activity_1 = std::make_shared<activity_data>();
+    activity_1->h_actor_id = actor_data_1->h_actor_id;
+    activity_1->initial_attributes[algorithm_helper::calc_hash(actor::POSITION_NAME)] = vector3(0.0F, 1.0F, 0.0F);
+    activity_1->timeline = timeline;
+    activity_1->id = 1;
+
+    auto dialog_1 = std::make_shared<dialog_data>();
+    dialog_1->h_actor_id = actor_data_1->h_actor_id;
+    dialog_1->dialog_text = "test_text_1";
+
+    auto beat_1 = std::make_shared<beat_data>();
+    beat_1->activities = {{1, activity_1}};
+    beat_1->dialog = dialog_1;
+
+    auto data = std::make_shared<stage_data>();
+    data->h_stage_name = algorithm_helper::calc_hash("test_stage_native");
+    data->beats = {beat_1};
+    data->actors = {{actor_data_1->h_actor_id, actor_data_1}};
+    data->actions = {{move_data->h_action_name, move_data}};
+    data->default_text_style = std::make_shared<text_style_data>();
+    data->default_text_style->font_size = kDefaultFontSize;
+    data->default_text_style->font_weight = kDefaultFontWeight;
+    data->default_text_style->font_family = "Arial";
+
+    // registered data comes with compiled layouts, so the timeline and the registry go through slots
+    EXPECT_EQ(_manager->register_stage_data(data), data->h_stage_name);
+    EXPECT_NO_THROW(_manager->configure_stage(*_stage, data->h_stage_name));
+    EXPECT_NO_THROW(_stage->advance());
+
+    auto *p_actor = _stage->get_actor(1);
+    ASSERT_NE(p_actor, nullptr);
+    auto *attributes = p_actor->get_attributes();
+    ASSERT_NE(attributes, nullptr);
+    const auto *p_layout = attributes->get_layout();
+    ASSERT_NE(p_layout, nullptr);
+    EXPECT_EQ(p_layout, _stage->get_attribute_layout(actor_data_1->h_actor_type).get());
+    const auto position_slot = p_layout->find_slot(algorithm_helper::calc_hash(actor::POSITION_NAME));
+    ASSERT_NE(position_slot, attribute_layout::INVALID_SLOT);
+
+    EXPECT_NO_THROW(_stage->update(kUpdateTime1));
+    EXPECT_TRUE(attributes->get(algorithm_helper::calc_hash(actor::POSITION_NAME))->approx_equals(vector3(.1F, .2F, .3F)));
+
+    EXPECT_NO_THROW(_stage->update(kUpdateTime11));
+    EXPECT_TRUE(attributes->get(algorithm_helper::calc_hash(actor::POSITION_NAME))->approx_equals(vector3(1.0F, 2.0F, 3.0F)));
+    EXPECT_EQ(attributes->get_at(position_slot), attributes->get(algorithm_helper::calc_hash(actor::POSITION_NAME)));
+
+    poll_event();
+    print_failures();
+    EXPECT_TRUE(_failures.empty()) << "Expected no node failures, but " << _failures.size() << " failure(s) occurred";
+
+    EXPECT_NO_THROW(_stage->fina());
+    _manager->unregister_stage_data(data->h_stage_name);
+    EXPECT_EQ(_manager->get_attribute_layouts(data->h_stage_name), nullptr);
+}
+
+TEST(attribute_registry_test_suite, dirty_tracking) {
+    attribute_registry attributes;
+    const auto h_position = algorithm_helper::calc_hash_const("position");
+    const auto h_alpha = algorithm_helper::calc_hash_const("alpha");
+
+    attributes.set(h_position, variant(vector3(1.0F, 2.0F, 3.0F)));
+    const auto *p_position = attributes.get(h_position);
+    attributes.set(h_alpha, variant(0.5F));
+    attributes.set(h_position, variant(vector3(1.0F, 2.0F, 4.0F)));
+
+    // each key is listed once, in first-touched order
+    auto dirty = attributes.peek_dirty_attributes();
+    ASSERT_EQ(dirty.size(), 2);
+    EXPECT_EQ(dirty[0], h_position);
+    EXPECT_EQ(dirty[1], h_alpha);
+    EXPECT_EQ(attributes.get_count(), 2);
+
+    // pointers stay valid across later inserts
+    for (hash_t h_key = 1; h_key <= 64; h_key++) {
+        attributes.add(h_key, variant(static_cast<integer_t>(h_key)));
+    }
+    EXPECT_EQ(attributes.get(h_position), p_position);
+    EXPECT_EQ(*p_position, variant(vector3(1.0F, 2.0F, 4.0F)));
+
+    attributes.clear_dirty_attributes();
+    EXPECT_TRUE(attributes.peek_dirty_attributes().empty());
+
+    // approximately equal values are not dirty
+    attributes.set(h_alpha, variant(0.5F));
+    EXPECT_TRUE(attributes.peek_dirty_attributes().empty());
+
+    EXPECT_TRUE(attributes.remove(h_alpha));
+    EXPECT_FALSE(attributes.remove(h_alpha));
+    EXPECT_EQ(attributes.get(h_alpha), nullptr);
+    EXPECT_FALSE(attributes.contains_key(h_alpha));
+    ASSERT_EQ(attributes.peek_dirty_attributes().size(), 1);
+    EXPECT_EQ(attributes.peek_dirty_attributes()[0], h_alpha);
+    EXPECT_EQ(attributes.get_count(), 65);
+
+    attributes.clear();
+    EXPECT_EQ(attributes.get_count(), 0);
+    EXPECT_EQ(attributes.peek_dirty_attributes().size(), 66);
+}
+
+TEST(attribute_registry_test_suite, merge_update) {
+    attribute_registry attributes;
+    for (hash_t h_key = 10; h_key <= 50; h_key += 10) {
+        attributes.set(h_key, variant(static_cast<integer_t>(h_key)));
+    }
+    attributes.clear_dirty_attributes();
+
+    // interleaves unchanged, changed and new keys
+    frame_attribute_map values;
+    values.emplace(5, variant(5));
+    values.emplace(10, variant(10));
+    values.emplace(25, variant(text_t("attribute value that does not fit into SSO")));
+    values.emplace(30, variant(31));
+    values.emplace(60, variant(60));
+    attributes.update(std::move(values));
+
+    EXPECT_EQ(attributes.get_count(), 8);
+    for (const auto h_key : {5ULL, 10ULL, 20ULL, 25ULL, 30ULL, 40ULL, 50ULL, 60ULL}) {
+        EXPECT_NE(attributes.get(h_key), nullptr) << h_key;
+    }
+    EXPECT_EQ(*attributes.get(30), variant(31));
+    EXPECT_EQ(attributes.get(25)->get_text(), "attribute value that does not fit into SSO");
+
+    auto dirty = attributes.peek_dirty_attributes();
+    EXPECT_EQ(std::vector<hash_t>(dirty.begin(), dirty.end()), (std::vector<hash_t>{5, 25, 30, 60}));
+
+    // newly merged keys are found by later lookups and updates
+    frame_attribute_map more;
+    more.emplace(25, variant(0));
+    more.emplace(55, variant(55));
+    attributes.update(more);
+    EXPECT_EQ(*attributes.get(25), variant(0));
+    EXPECT_EQ(*attributes.get(55), variant(55));
+    EXPECT_EQ(attributes.get_count(), 9);
+}
+
+TEST(attribute_registry_test_suite, merge_update_vector_runs) {
+    // runs of each vector kind longer than one batch, broken up by a key whose kind changes
+    attribute_registry attributes;
+    frame_attribute_map values;
+    for (hash_t h_key = 1; h_key <= 300; h_key++) {
+        const auto x = static_cast<number_t>(h_key);
+        if (h_key <= 100) {
+            values.insert_or_assign(h_key, variant(vector2(x, x)));
+        } else if (h_key <= 200) {
+            values.insert_or_assign(h_key, variant(vector3(x, x, x)));
+        } else {
+            values.insert_or_assign(h_key, variant(vector4(x, x, x, x)));
+        }
+    }
+    attributes.update(values);
+    attributes.clear_dirty_attributes();
+
+    // every seventh vector moves and key 150 turns into a number; the rest are unchanged
+    std::vector<hash_t> expected;
+    for (auto &[h_key, value] : values) {
+        if (h_key == 150) {
+            value = variant(1.0F);
+        } else if (h_key % 7 == 0) {
+            switch (value.get_value_type()) {
+            case variant::VECTOR2:
+                value = variant(value.get_vector2() + vector2(0.5F, 0.0F));
+                break;
+            case variant::VECTOR3:
+                value = variant(value.get_vector3() + vector3(0.0F, 0.0F, 0.5F));
+                break;
+            default:
+                value = variant(value.get_vector4() + vector4(0.0F, 0.5F, 0.0F, 0.0F));
+                break;
+            }
+        } else {
+            continue;
+        }
+        expected.push_back(h_key);
+    }
+    attributes.update(values);
+
+    auto dirty = attributes.peek_dirty_attributes();
+    EXPECT_EQ(std::vector<hash_t>(dirty.begin(), dirty.end()), expected);
+    EXPECT_EQ(*attributes.get(7), variant(vector2(7.5F, 7.0F)));
+    EXPECT_EQ(*attributes.get(150), variant(1.0F));
+    EXPECT_EQ(*attributes.get(203), variant(vector4(203.0F, 203.5F, 203.0F, 203.0F)));
+}
+
+TEST(attribute_registry_test_suite, layout_slots) {
+    const auto h_position = algorithm_helper::calc_hash_const("position");
+    const auto h_scale = algorithm_helper::calc_hash_const("scale");
+    const auto h_extra = algorithm_helper::calc_hash_const("extra");
+
+    auto actor_1 = std::make_shared<actor_data>();
+    actor_1->h_actor_type = 1ULL;
+    actor_1->default_attributes[h_position] = vector3(0.0F, 0.0F, 0.0F);
+    auto actor_2 = std::make_shared<actor_data>();
+    actor_2->h_actor_type = 1ULL;
+    actor_2->default_attributes[h_position] = vector3(1.0F, 0.0F, 0.0F);
+    actor_2->default_attributes[h_scale] = vector3(1.0F, 1.0F, 1.0F);
+    std::map<hash_t, std::shared_ptr<actor_data>> actors{{10ULL, actor_1}, {11ULL, actor_2}};
+
+    auto layouts = attribute_layout::compile(actors);
+    ASSERT_EQ(layouts.size(), 1);
+    const auto p_layout = layouts.at(1ULL);
+    ASSERT_EQ(p_layout->get_size(), 2);
+    EXPECT_EQ(p_layout->find_slot(h_extra), attribute_layout::INVALID_SLOT);
+    const auto position_slot = p_layout->find_slot(h_position);
+    const auto scale_slot = p_layout->find_slot(h_scale);
+    ASSERT_NE(position_slot, attribute_layout::INVALID_SLOT);
+    ASSERT_NE(scale_slot, attribute_layout::INVALID_SLOT);
+    EXPECT_EQ(p_layout->get_key(position_slot), h_position);
+
+    // binding keeps values and pointers handed out before, and reserves nothing for keys that were never set
+    attribute_registry attributes;
+    attributes.set(h_extra, variant(1));
+    attributes.set(h_position, variant(vector3(1.0F, 2.0F, 3.0F)));
+    const auto *p_position = attributes.get(h_position);
+    const auto p_snapshot = attributes.take_snapshot();
+    attributes.bind_layout(p_layout);
+    EXPECT_EQ(attributes.get_at(position_slot), p_position);
+    EXPECT_EQ(attributes.get_at(scale_slot), nullptr);
+    EXPECT_EQ(attributes.take_snapshot(), p_snapshot);
+    EXPECT_EQ(attributes.get_count(), 2);
+
+    attributes.clear_dirty_attributes();
+    attributes.set_at(position_slot, variant(vector3(4.0F, 5.0F, 6.0F)));
+    EXPECT_EQ(*attributes.get(h_position), variant(vector3(4.0F, 5.0F, 6.0F)));
+    ASSERT_EQ(attributes.peek_dirty_attributes().size(), 1);
+    EXPECT_EQ(attributes.peek_dirty_attributes()[0], h_position);
+
+    // a slot is reserved on its first write, whether it comes by slot, by key or from a layer
+    attributes.set(h_scale, variant(vector3(2.0F, 2.0F, 2.0F)));
+    EXPECT_EQ(attributes.get_at(scale_slot), attributes.get(h_scale));
+
+    frame_arena arena;
+    const std::map<hash_t, variant> initial{{h_position, variant(vector3(4.0F, 5.0F, 6.0F))}, {h_extra, variant(1)}};
+    const std::vector<const variant *> initial_slots{&initial.at(h_position), nullptr};
+    frame_attribute_layer layer(initial, p_layout.get(), initial_slots, &arena);
+    layer.set_at(scale_slot, variant(vector3(3.0F, 3.0F, 3.0F)));
+    attributes.clear_dirty_attributes();
+    attributes.update(layer);
+    EXPECT_EQ(*attributes.get_at(scale_slot), variant(vector3(3.0F, 3.0F, 3.0F)));
+    ASSERT_EQ(attributes.peek_dirty_attributes().size(), 1);
+    EXPECT_EQ(attributes.peek_dirty_attributes()[0], h_scale);
+}
+
+TEST(attribute_registry_test_suite, tolerance) {
+    const auto h_position = algorithm_helper::calc_hash_const("position");
+    const auto h_alpha = algorithm_helper::calc_hash_const("alpha");
+
+    attribute_registry attributes;
+    attributes.set_tolerance(h_position, {.threshold = 0.5F});
+    attributes.set_tolerance(h_alpha, {.quantization_step = 0.25F});
+
+    attributes.set(h_position, variant(vector3(1.0F, 1.0F, 1.0F)));
+    attributes.set(h_alpha, variant(0.3F));
+    EXPECT_EQ(*attributes.get(h_alpha), variant(0.25F));
+    EXPECT_EQ(attributes.peek_dirty_attributes().size(), 2);
+    attributes.clear_dirty_attributes();
+
+    // jitter below the threshold or within one quantization step is dropped
+    attributes.set(h_position, variant(vector3(1.2F, 0.9F, 1.4F)));
+    attributes.set(h_alpha, variant(0.2F));
+    EXPECT_TRUE(attributes.peek_dirty_attributes().empty());
+    EXPECT_EQ(attributes.get_suppressed_change_count(), 2);
+    EXPECT_EQ(*attributes.get(h_position), variant(vector3(1.0F, 1.0F, 1.0F)));
+
+    // drift is measured against the last reported value, so it is reported once it adds up
+    attributes.set(h_position, variant(vector3(1.6F, 1.0F, 1.0F)));
+    attributes.set(h_alpha, variant(0.4F));
+    EXPECT_EQ(attributes.peek_dirty_attributes().size(), 2);
+    EXPECT_EQ(*attributes.get(h_alpha), variant(0.5F));
+    EXPECT_EQ(attributes.get_suppressed_change_count(), 2);
+
+    // configuring a key the registry does not hold adds no slot, the tolerance applies once the key shows up
+    const auto h_scale = algorithm_helper::calc_hash_const("scale");
+    const auto p_snapshot = attributes.take_snapshot();
+    attributes.set_tolerance(h_scale, {.quantization_step = 0.5F});
+    EXPECT_EQ(attributes.take_snapshot(), p_snapshot);
+    frame_attribute_map values;
+    values.emplace(h_scale, variant(0.8F));
+    attributes.update(values);
+    EXPECT_EQ(*attributes.get(h_scale), variant(1.0F));
+}
+
+TEST(attribute_registry_test_suite, history) {
+    const auto h_alpha = algorithm_helper::calc_hash_const("alpha");
+
+    attribute_history history(3);
+    history.record(1.0F, variant(1));
+    history.record(2.0F, variant(2));
+    history.record(3.0F, variant(3));
+    history.record(4.0F, variant(4));
+    EXPECT_EQ(history.get_size(), 3);
+    EXPECT_EQ(history.sample(1.5F), nullptr);
+    EXPECT_EQ(*history.sample(2.5F), variant(2));
+    EXPECT_EQ(*history.sample(10.0F), variant(4));
+
+    // recording in the past drops the samples after it
+    history.record(2.5F, variant(25));
+    EXPECT_EQ(history.get_size(), 2);
+    EXPECT_EQ(*history.sample(3.5F), variant(25));
+
+    attribute_registry attributes;
+    attributes.enable_history(8);
+    for (integer_t frame = 0; frame < 4; frame++) {
+        attributes.set(h_alpha, variant(frame));
+        attributes.record_history(static_cast<number_t>(frame));
+        attributes.clear_dirty_attributes();
+    }
+    attributes.remove(h_alpha);
+    attributes.record_history(4.0F);
+    attributes.clear_dirty_attributes();
+
+    EXPECT_EQ(*attributes.get_at_time(h_alpha, 1.5F), variant(1));
+    EXPECT_EQ(*attributes.get_at_time(h_alpha, 3.0F), variant(3));
+    EXPECT_EQ(attributes.get_at_time(h_alpha, 4.0F), nullptr);
+    EXPECT_EQ(attributes.get_at_time(h_alpha, -1.0F), nullptr);
+
+    // rewinding and playing again replaces the recorded future
+    attributes.set(h_alpha, variant(10));
+    attributes.record_history(2.0F);
+    EXPECT_EQ(*attributes.get_at_time(h_alpha, 3.0F), variant(10));
+}
+
+TEST(attribute_registry_test_suite, snapshot) {
+    attribute_registry attributes;
+    for (hash_t h_key = 0; h_key < 100; h_key++) {
+        attributes.set(h_key, variant(static_cast<integer_t>(h_key)));
+    }
+
+    const auto p_first = attributes.take_snapshot();
+    EXPECT_EQ(p_first->get_count(), 100);
+    EXPECT_EQ(attributes.take_snapshot(), p_first);
+
+    // the writer moves on, the reader still sees the old version
+    attributes.set(3, variant(text_t("attribute value that does not fit into SSO")));
+    attributes.remove(4);
+    const auto p_second = attributes.take_snapshot();
+    EXPECT_GT(p_second->get_version(), p_first->get_version());
+    EXPECT_EQ(*p_first->get(3), variant(3));
+    EXPECT_EQ(*p_first->get(4), variant(4));
+    EXPECT_EQ(p_second->get(3)->get_text(), "attribute value that does not fit into SSO");
+    EXPECT_EQ(p_second->get(4), nullptr);
+    EXPECT_EQ(p_second->get_count(), 99);
+
+    // only the chunk that was written is copied
+    EXPECT_NE(p_second->get(3), p_first->get(3));
+    EXPECT_EQ(p_second->get(99), p_first->get(99));
+
+    attributes.set(1000, variant(1000));
+    const auto p_third = attributes.take_snapshot();
+    EXPECT_EQ(*p_third->get(1000), variant(1000));
+    EXPECT_EQ(p_second->get(1000), nullptr);
+
+    size_t visited = 0;
+    p_third->for_each([&visited](hash_t, const variant &) { visited++; });
+    EXPECT_EQ(visited, 100);
+}
+
+TEST(event_ring_test_suite, overflow_keeps_order) {
+    manager mgr("event_ring");
+    mgr.enable_event_ring(4);
+    auto *p_ring = mgr.get_event_ring();
+    ASSERT_NE(p_ring, nullptr);
+
+    for (integer_t i = 0; i < 10; i++) {
+        mgr.enqueue_event<log_event>(std::to_string(i), LOG_INFO);
+    }
+    EXPECT_TRUE(mgr.get_event_queue().empty());
+    auto statistics = mgr.get_event_ring_statistics();
+    EXPECT_EQ(statistics.pushed_count, 4);
+    EXPECT_EQ(statistics.full_count, 6);
+    EXPECT_EQ(statistics.overflow_peak, 6);
+
+    std::vector<text_t> received;
+    const auto receive = [&received](std::shared_ptr<event> &&e) { received.push_back(static_cast<const log_event &>(*e).message); };
+    while (received.size() < 10) {
+        p_ring->drain(receive);
+        mgr.flush_event_overflow();
+    }
+    for (size_t i = 0; i < 10; i++) {
+        EXPECT_EQ(received[i], std::to_string(i));
+    }
+    statistics = mgr.get_event_ring_statistics();
+    EXPECT_EQ(statistics.pushed_count, 10);
+    EXPECT_EQ(statistics.overflow_size, 0);
+
+    // the ring belongs to its consumer, flushing does not take events from it
+    mgr.enqueue_event<log_event>("ring", LOG_INFO);
+    flatbuffers::FlatBufferBuilder builder;
+    EXPECT_EQ(mgr.flush_events(builder), 0);
+    EXPECT_EQ(builder.GetSize(), 0);
+    ASSERT_EQ(p_ring->get_size(), 2);
+    std::shared_ptr<event> p_event;
+    ASSERT_TRUE(p_ring->try_pop(p_event));
+    EXPECT_EQ(static_cast<const log_event &>(*p_event).message, "ring");
+}
+
+TEST(event_ring_test_suite, concurrent_consumer) {
+    constexpr size_t EVENT_COUNT = 100000;
+    spsc_ring<integer_t> ring(64);
+
+    std::vector<integer_t> received;
+    received.reserve(EVENT_COUNT);
+    std::thread consumer([&] {
+        integer_t value = 0;
+        while (received.size() < EVENT_COUNT) {
+            if (ring.try_pop(value)) {
+                received.push_back(value);
+            }
+        }
+    });
+    for (size_t i = 0; i < EVENT_COUNT; i++) {
+        auto value = static_cast<integer_t>(i);
+        while (!ring.try_push(std::move(value))) {
+        }
+    }
+    consumer.join();
+
+    ASSERT_EQ(received.size(), EVENT_COUNT);
+    for (size_t i = 0; i < EVENT_COUNT; i++) {
+        ASSERT_EQ(received[i], static_cast<integer_t>(i));
+    }
+}
+
+TEST(event_pool_test_suite, pooled_events) {
+    manager mgr("event_pool");
+    for (integer_t frame = 0; frame < 3; frame++) {
+        mgr.log(std::to_string(frame), LOG_INFO);
+        mgr.enqueue_event<log_event>("second", LOG_WARN);
+        ASSERT_EQ(mgr.get_event_queue().size(), 2);
+        EXPECT_EQ(static_cast<const log_event &>(*mgr.get_event_queue()[0]).message, std::to_string(frame));
+        EXPECT_EQ(static_cast<const log_event &>(*mgr.get_event_queue()[1]).level, LOG_WARN);
+        mgr.clear_event_queue();
+    }
+
+    node_attribute_dirty_event::dirty_attributes_vector dirty_attributes(mgr.get_event_resource());
+    EXPECT_EQ(dirty_attributes.get_allocator().resource(), mgr.get_event_resource());
+}
+
+TEST(event_pool_test_suite, events_outlive_manager) {
+    const variant value(1);
+    std::vector<std::shared_ptr<event>> events;
+    {
+        manager mgr("outlived");
+        auto p_dialog = mgr.new_live_object<dialog>();
+        mgr.log("kept", LOG_INFO);
+        node_attribute_dirty_event::dirty_attributes_vector dirty_attributes({{1, &value}}, mgr.get_event_resource());
+        mgr.enqueue_event<node_attribute_dirty_event>(*p_dialog, std::move(dirty_attributes));
+        events = mgr.get_event_queue();
+    }
+
+    // the pool the events and their buffers live in is released with the last of them
+    ASSERT_EQ(events.size(), 2);
+    EXPECT_EQ(static_cast<const log_event &>(*events[0]).message, "kept");
+    EXPECT_EQ(static_cast<const node_attribute_dirty_event &>(*events[1]).dirty_attributes[0].second, &value);
+    events.clear();
+}
+
+TEST(event_coalescing_test_suite, coalesce_dirty_events) {
+    manager mgr("coalesce");
+    auto p_first = mgr.new_live_object<dialog>();
+    auto p_second = mgr.new_live_object<dialog>();
+    const variant old_value(1);
+    const variant new_value(2);
+    const variant other_value(3);
+
+    const auto enqueue_dirty = [&mgr](const node &n, std::initializer_list<std::pair<hash_t, const variant *>> attributes) {
+        node_attribute_dirty_event::dirty_attributes_vector dirty_attributes(attributes, mgr.get_event_resource());
+        mgr.enqueue_event<node_attribute_dirty_event>(n, std::move(dirty_attributes));
+    };
+    enqueue_dirty(*p_first, {{1, &old_value}, {2, &old_value}});
+    enqueue_dirty(*p_second, {{1, &other_value}});
+    enqueue_dirty(*p_first, {{2, &new_value}, {3, &new_value}});
+    mgr.enqueue_event<node_fina_event>(*p_first);
+    enqueue_dirty(*p_first, {{1, &new_value}});
+    const auto copied = mgr.get_event_queue();
+
+    EXPECT_EQ(mgr.coalesce_events(), 1);
+    const auto &queue = mgr.get_event_queue();
+    ASSERT_EQ(queue.size(), 4);
+
+    // the merge goes into a new event, copies of the queue still see what was enqueued
+    EXPECT_NE(queue[0], copied[0]);
+    EXPECT_EQ(static_cast<const node_attribute_dirty_event &>(*copied[0]).dirty_attributes.size(), 2);
+    EXPECT_EQ(static_cast<const node_attribute_dirty_event &>(*copied[2]).dirty_attributes.size(), 2);
+    EXPECT_EQ(queue[1], copied[1]);
+
+    const auto &merged = static_cast<const node_attribute_dirty_event &>(*queue[0]);
+    EXPECT_EQ(merged.node_handle, p_first->get_handle());
+    ASSERT_EQ(merged.dirty_attributes.size(), 3);
+    EXPECT_EQ(merged.dirty_attributes[0].second, &old_value);
+    EXPECT_EQ(merged.dirty_attributes[1].second, &new_value);
+    EXPECT_EQ(merged.dirty_attributes[2].second, &new_value);
+    EXPECT_EQ(static_cast<const node_attribute_dirty_event &>(*queue[1]).node_handle, p_second->get_handle());
+    EXPECT_EQ(queue[2]->get_event_type(), EVENT_NODE_FINA);
+    EXPECT_EQ(queue[3]->get_event_type(), EVENT_NODE_ATTRIBUTE_DIRTY);
+
+    EXPECT_EQ(mgr.get_event_coalescing_statistics().events_in, 4);
+    EXPECT_EQ(mgr.get_event_coalescing_statistics().events_out, 3);
+    mgr.clear_event_queue();
+
+    // changes on either side of any other event stay on their side of it
+    enqueue_dirty(*p_second, {{1, &old_value}});
+    mgr.log("between", LOG_INFO);
+    enqueue_dirty(*p_second, {{1, &new_value}});
+    EXPECT_EQ(mgr.coalesce_events(), 0);
+    ASSERT_EQ(queue.size(), 3);
+    EXPECT_EQ(queue[1]->get_event_type(), EVENT_LOG);
+    EXPECT_EQ(static_cast<const node_attribute_dirty_event &>(*queue[2]).dirty_attributes[0].second, &new_value);
+    mgr.clear_event_queue();
+}
+
+TEST(attribute_value_log_test_suite, dirty_event_owns_values) {
+    manager mgr("value_log");
+    auto p_dialog = mgr.new_live_object<dialog>();
+    attribute_registry attributes;
+    attributes.set(1, variant(text_t("attribute value that does not fit into SSO")));
+
+    const auto &p_values = mgr.get_attribute_value_log();
+    node_attribute_dirty_event::dirty_attributes_vector dirty_attributes(mgr.get_event_resource());
+    dirty_attributes.emplace_back(1, p_values->append(*attributes.get(1)));
+    mgr.enqueue_event<node_attribute_dirty_event>(*p_dialog, std::move(dirty_attributes), p_values);
+    const auto *p_log = p_values.get();
+
+    // the registry moves on, the queued event still reports the value it was sent with
+    attributes.set(1, variant(2));
+    const auto p_event = mgr.get_event_queue()[0];
+    const auto &dirty_event = static_cast<const node_attribute_dirty_event &>(*p_event);
+    EXPECT_EQ(dirty_event.dirty_attributes[0].second->get_text(), "attribute value that does not fit into SSO");
+
+    // a log still referenced by an event is not reused
+    mgr.clear_event_queue();
+    EXPECT_NE(mgr.get_attribute_value_log().get(), p_log);
+    EXPECT_EQ(dirty_event.dirty_attributes[0].second->get_text(), "attribute value that does not fit into SSO");
+}
+
+namespace {
+// Provides what the logging macros expect from a node and counts how often the locator is formatted
+struct log_probe {
+    manager &mgr;
+    mutable integer_t locator_count{0};
+    mutable integer_t message_count{0};
+
+    [[nodiscard]] manager &get_manager() const { return mgr; }
+    static std::string get_class_name() { return "log_probe"; }
+    [[nodiscard]] std::string get_locator() const {
+        locator_count++;
+        return "Probe";
+    }
+    [[nodiscard]] std::string make_message() const {
+        message_count++;
+        return "message";
+    }
+    void warn() const { WARN_LOG(make_message()); }
+};
+} // namespace
+
+TEST(logging_test_suite, level_gated_logging) {
+    manager mgr("logging");
+    const log_probe probe{mgr};
+
+    mgr.set_min_log_level(LOG_ERROR);
+    probe.warn();
+    mgr.log("dropped", LOG_INFO);
+    EXPECT_TRUE(mgr.get_event_queue().empty());
+    EXPECT_EQ(probe.message_count, 0);
+    EXPECT_EQ(probe.locator_count, 0);
+
+    // the locator is formatted when the event is resolved or serialized, not when it is logged
+    mgr.set_min_log_level(LOG_WARN);
+    probe.warn();
+    ASSERT_EQ(mgr.get_event_queue().size(), 1);
+    const auto &logged = static_cast<const log_event &>(*mgr.get_event_queue()[0]);
+    EXPECT_EQ(logged.message, "log_probe: message");
+    EXPECT_EQ(probe.locator_count, 0);
+    mgr.resolve_log_locators();
+    EXPECT_EQ(logged.locator, "Probe");
+    EXPECT_EQ(logged.get_text(), "log_probe: message\nProbe");
+    EXPECT_EQ(probe.locator_count, 1);
+    mgr.clear_event_queue();
+
+    probe.warn();
+    flatbuffers::FlatBufferBuilder builder;
+    EXPECT_EQ(mgr.flush_events(builder), 1);
+    EXPECT_EQ(probe.locator_count, 2);
+    const auto *p_batch = fb::GetEventBatch(builder.GetBufferPointer());
+    EXPECT_EQ(p_batch->events()->GetAs<fb::LogEvent>(0)->message()->str(), "log_probe: message\nProbe");
+}
+
+TEST(logging_test_suite, flushed_locator_outlives_node) {
+    manager mgr("logging");
+    auto p_dialog = mgr.new_live_object<dialog>();
+    integer_t locator_count = 0;
+    mgr.log("message", LOG_WARN, [&locator_count, p_node = p_dialog.get()] {
+        locator_count++;
+        return p_node->get_locator();
+    });
+    const auto copied = mgr.get_event_queue();
+
+    // flushing resolves the locator, so reading the copy later does not reach back into the node
+    flatbuffers::FlatBufferBuilder builder;
+    EXPECT_EQ(mgr.flush_events(builder), 1);
+    EXPECT_EQ(locator_count, 1);
+    p_dialog->fina();
+    p_dialog.reset();
+
+    ASSERT_EQ(copied.size(), 1);
+    EXPECT_EQ(static_cast<const log_event &>(*copied[0]).get_text(), "message\n??? > Dialog");
+    EXPECT_EQ(locator_count, 1);
+}
@@ -1,8 +1,17 @@
-﻿#include "helper/algorithm_helper.h"
+﻿#include "frame_arena.h"
+#include "helper/algorithm_helper.h"
+#include "string_interner.h"
 #include "variant.h"
 #include "gtest/gtest.h"
+#include <cmath>
+#include <map>
+#include <memory>
+#include <span>
+#include <stdexcept>
 #include <unordered_map>
 #include <unordered_set>
+#include <utility>
+#include <vector>
 
 using namespace camellia;
 
@@ -34,6 +43,128 @@ TEST(variant_test_suite, approx_equality) {
     ASSERT_TRUE(b.approx_equals(c));
 }
 
+TEST(variant_test_suite, vector_approx_equals_lanes) {
+    // a spread of exact, near and far pairs across small and large magnitudes
+    const std::vector<number_t> bases = {0.0F, 1.0F, -0.5F, 30000.0F, -1e6F, 1e-7F, 123.456F};
+    const std::vector<number_t> offsets = {0.0F, 1e-8F, 1e-3F, 2.0F};
+    std::vector<number_t> lhs;
+    std::vector<number_t> rhs;
+    for (auto base : bases) {
+        for (auto offset : offsets) {
+            lhs.push_back(base);
+            rhs.push_back(base + offset * std::max(1.0F, std::fabs(base)));
+        }
+    }
+
+    // the lane kernel agrees with the scalar helper for every length, including partial registers
+    for (size_t count = 0; count <= lhs.size(); count++) {
+        auto expected = true;
+        for (size_t i = 0; i < count; i++) {
+            expected = expected && algorithm_helper::approx_equals(lhs[i], rhs[i]);
+        }
+        ASSERT_EQ(algorithm_helper::approx_equals(lhs.data(), rhs.data(), count), expected) << count;
+    }
+
+    // the vector types go through the same kernel
+    for (size_t i = 0; i + 4 <= lhs.size(); i += 3) {
+        auto expected = true;
+        for (size_t d = 0; d < 4; d++) {
+            expected = expected && algorithm_helper::approx_equals(lhs[i + d], rhs[i + d]);
+            if (d == 1) {
+                ASSERT_EQ(vector2(lhs[i], lhs[i + 1]).approx_equals(vector2(rhs[i], rhs[i + 1])), expected) << i;
+            } else if (d == 2) {
+                ASSERT_EQ(vector3(lhs[i], lhs[i + 1], lhs[i + 2]).approx_equals(vector3(rhs[i], rhs[i + 1], rhs[i + 2])), expected) << i;
+            }
+        }
+        ASSERT_EQ(vector4(lhs[i], lhs[i + 1], lhs[i + 2], lhs[i + 3]).approx_equals(vector4(rhs[i], rhs[i + 1], rhs[i + 2], rhs[i + 3])), expected) << i;
+    }
+}
+
+TEST(variant_test_suite, vector_approx_equals_batch) {
+    const std::vector<number_t> bases = {0.0F, 1.0F, -0.5F, 30000.0F, -1e6F, 1e-7F, 123.456F};
+    const std::vector<number_t> offsets = {0.0F, 1e-8F, 1e-3F, 2.0F};
+    std::vector<vector2> a2, b2;
+    std::vector<vector3> a3, b3;
+    std::vector<vector4> a4, b4;
+    for (auto base : bases) {
+        for (auto offset : offsets) {
+            auto other = base + offset * std::max(1.0F, std::fabs(base));
+            a2.emplace_back(base, base);
+            b2.emplace_back(base, other);
+            a3.emplace_back(other, base, base);
+            b3.emplace_back(base, base, base);
+            a4.emplace_back(base, base, base, other);
+            b4.emplace_back(base, base, base, base);
+        }
+    }
+
+    auto check = [](const auto &a, const auto &b) {
+        // std::vector<bool> is not contiguous, so results go into a plain array
+        auto out = std::make_unique<boolean_t[]>(a.size());
+        algorithm_helper::approx_equals_batch(std::span(a), std::span(b), std::span(out.get(), a.size()));
+        for (size_t i = 0; i < a.size(); i++) {
+            ASSERT_EQ(out[i], a[i].approx_equals(b[i])) << i;
+        }
+    };
+    check(a2, b2);
+    check(a3, b3);
+    check(a4, b4);
+
+    // odd-sized batches exercise the padded tail
+    a2.pop_back();
+    b2.pop_back();
+    check(a2, b2);
+    a3.pop_back();
+    b3.pop_back();
+    check(a3, b3);
+
+    boolean_t too_small[1];
+    ASSERT_THROW(algorithm_helper::approx_equals_batch(std::span<const vector4>(a4), std::span<const vector4>(b4), std::span(too_small)),
+                 std::invalid_argument);
+}
+
+TEST(variant_test_suite, vector_arithmetic_and_lerp) {
+    ASSERT_EQ(vector3(1.0F, 2.0F, 3.0F) + vector3(0.5F, 0.5F, 0.5F), vector3(1.5F, 2.5F, 3.5F));
+    ASSERT_EQ(vector2(1.0F, 2.0F) - vector2(1.0F, 1.0F), vector2(0.0F, 1.0F));
+    ASSERT_EQ(vector4(1.0F, 2.0F, 3.0F, 4.0F) * 2.0F, vector4(2.0F, 4.0F, 6.0F, 8.0F));
+    ASSERT_EQ(vector2::lerp(vector2(0.0F, 10.0F), vector2(10.0F, 0.0F), 0.25F), vector2(2.5F, 7.5F));
+
+    // INTEGER stays INTEGER only when both sides are INTEGER
+    ASSERT_EQ(variant(2).add(variant(3)), variant(5));
+    ASSERT_EQ(variant(2).subtract(variant(0.5F)), variant(1.5F));
+    ASSERT_EQ(variant(3).scale(0.5F), variant(1.5F));
+    ASSERT_EQ(variant(vector3(1.0F, 2.0F, 3.0F)).add(vector3(1.0F, 1.0F, 1.0F)), variant(vector3(2.0F, 3.0F, 4.0F)));
+    ASSERT_EQ(variant(vector4(1.0F, 2.0F, 3.0F, 4.0F)).scale(0.5F), variant(vector4(0.5F, 1.0F, 1.5F, 2.0F)));
+
+    ASSERT_EQ(variant::lerp(variant(0), variant(10), 0.3F), variant(3.0F));
+    ASSERT_TRUE(variant::lerp(variant(vector3(0.0F, 1.0F, 0.0F)), variant(vector3(1.0F, 2.0F, 3.0F)), 0.5F).approx_equals(vector3(0.5F, 1.5F, 1.5F)));
+
+    // mismatched or non-arithmetic kinds are rejected
+    ASSERT_THROW((void)variant(vector2(0.0F, 0.0F)).add(vector3(0.0F, 0.0F, 0.0F)), std::bad_variant_access);
+    ASSERT_THROW((void)variant("text").scale(2.0F), std::bad_variant_access);
+    ASSERT_THROW((void)variant::lerp(variant(1), variant(true), 0.5F), std::bad_variant_access);
+}
+
+TEST(variant_test_suite, easing_curves) {
+    using namespace algorithm_helper;
+    for (auto type : {EASE_LINEAR, EASE_IN_QUAD, EASE_OUT_QUAD, EASE_IN_OUT_QUAD, EASE_IN_CUBIC, EASE_OUT_CUBIC, EASE_IN_OUT_CUBIC, EASE_SMOOTHSTEP}) {
+        // every curve starts at 0, ends at 1 and clamps progress outside [0, 1]
+        ASSERT_FLOAT_EQ(ease(type, 0.0F), 0.0F);
+        ASSERT_FLOAT_EQ(ease(type, 1.0F), 1.0F);
+        ASSERT_FLOAT_EQ(ease(type, -1.0F), 0.0F);
+        ASSERT_FLOAT_EQ(ease(type, 2.0F), 1.0F);
+    }
+    ASSERT_FLOAT_EQ(ease(EASE_LINEAR, 0.25F), 0.25F);
+    ASSERT_FLOAT_EQ(ease(EASE_IN_QUAD, 0.5F), 0.25F);
+    ASSERT_FLOAT_EQ(ease(EASE_OUT_QUAD, 0.5F), 0.75F);
+    ASSERT_FLOAT_EQ(ease(EASE_IN_OUT_CUBIC, 0.5F), 0.5F);
+    ASSERT_FLOAT_EQ(ease(EASE_SMOOTHSTEP, 0.5F), 0.5F);
+
+    ASSERT_EQ(parse_easing("in_out_quad"), EASE_IN_OUT_QUAD);
+    ASSERT_EQ(parse_easing("smoothstep"), EASE_SMOOTHSTEP);
+    ASSERT_FALSE(parse_easing("bounce").has_value());
+}
+
 TEST(variant_test_suite, to_desc_basic_types) {
     // VOID type
     ASSERT_EQ(variant().to_desc(), "V");
@@ -210,6 +341,12 @@ TEST(variant_test_suite, from_desc_attribute_type) {
     ASSERT_EQ(variant::from_desc("A123456789ABCDEF0"), variant(hash_t(0x123456789ABCDEF0)));
     ASSERT_EQ(variant::from_desc("AFFFFFFFFFFFFFFFF"), variant(hash_t(0xFFFFFFFFFFFFFFFF)));
     ASSERT_EQ(variant::from_desc("A:hello"), variant(algorithm_helper::calc_hash("hello")));
+
+    // the name form inside a dictionary, as key and as value
+    const variant dictionary(variant_dictionary{{variant("k"), variant(algorithm_helper::calc_hash("foo"))},
+                                                {variant(algorithm_helper::calc_hash("bar")), variant(1)}});
+    ASSERT_EQ(variant::from_desc("{Tk:A:foo,A:bar:I1}"), dictionary);
+    ASSERT_EQ(variant::from_desc(dictionary.to_desc()), dictionary);
 }
 
 TEST(variant_test_suite, from_desc_to_desc_roundtrip) {
@@ -458,6 +595,46 @@ TEST(variant_test_suite, hash_consistency) {
     ASSERT_EQ(hash4, hash6);
 }
 
+TEST(variant_test_suite, hash_large_payloads) {
+    std::hash<variant> hasher;
+
+    // signed zeros compare equal, so they hash equal
+    ASSERT_EQ(hasher(variant(0.0F)), hasher(variant(-0.0F)));
+    ASSERT_EQ(hasher(variant(vector2(-0.0F, 1.0F))), hasher(variant(vector2(0.0F, 1.0F))));
+
+    bytes_t bytes(1 << 20U);
+    for (size_t i = 0; i < bytes.size(); i++) {
+        bytes[i] = static_cast<uint8_t>(i * 31U);
+    }
+    auto a = variant(bytes);
+    auto b = variant(bytes);
+    ASSERT_EQ(hasher(a), hasher(b));
+
+    // a shared payload caches its hash, an edit detaches and hashes the new content
+    auto a_copy = a;
+    const auto h_before = hasher(a);
+    ASSERT_EQ(hasher(a_copy), h_before);
+    a_copy.edit_bytes()[0] ^= 0xFFU;
+    ASSERT_NE(hasher(a_copy), h_before);
+    ASSERT_EQ(hasher(a), h_before);
+
+    // nested containers hash the same whether or not their hash was cached
+    std::vector<variant> elements(variant::HASH_CACHE_MIN_SIZE, variant(vector3(1.0F, 2.0F, 3.0F)));
+    auto inner = variant(elements);
+    auto inner_copy = inner;
+    auto outer_cached = variant(std::vector<variant>{inner, variant("tail")});
+    auto outer_fresh = variant(std::vector<variant>{variant(elements), variant("tail")});
+    ASSERT_EQ(hasher(inner), hasher(variant(elements)));
+    ASSERT_EQ(hasher(outer_cached), hasher(outer_fresh));
+
+    // unique payloads are never cached, so writes through an outstanding edit reference show up
+    inner = variant();
+    auto &edited = inner_copy.edit_array();
+    ASSERT_EQ(hasher(inner_copy), hasher(variant(elements)));
+    edited.emplace_back(1);
+    ASSERT_NE(hasher(inner_copy), hasher(variant(elements)));
+}
+
 TEST(variant_test_suite, unordered_map_update) {
     // Test that we can update values in an unordered_map with variant keys
     std::unordered_map<variant, std::string> map;
@@ -709,4 +886,228 @@ TEST(variant_test_suite, dictionary_complex_keys) {
 
     auto dict_var = variant(dict);
     ASSERT_EQ(dict_var.get_dictionary().size(), 3);
-}
\ No newline at end of file
+}
+
+TEST(variant_test_suite, copy_and_move_semantics) {
+    // inline kinds stay within a small footprint
+    static_assert(sizeof(variant) <= 24);
+
+    // copies of heap-backed kinds are independent
+    auto a = variant(std::vector<variant>{variant("x"), variant(1)});
+    auto b = a;
+    ASSERT_EQ(a, b);
+    b = variant(2);
+    ASSERT_EQ(a.get_array().size(), 2);
+    ASSERT_EQ(a.get_array()[0].get_text(), "x");
+
+    // moved-from variants become VOID
+    auto c = std::move(a);
+    ASSERT_EQ(c.get_array().size(), 2);
+    ASSERT_EQ(a.get_value_type(), variant::VOID); // NOLINT(bugprone-use-after-move)
+
+    // assigning from an element of the own payload is safe
+    c = c.get_array()[0];
+    ASSERT_EQ(c, variant("x"));
+
+    // accessing the wrong kind throws
+    ASSERT_THROW((void)c.get_vector3(), std::bad_variant_access);
+    ASSERT_THROW((void)static_cast<integer_t>(c), std::bad_variant_access);
+}
+
+TEST(variant_test_suite, dictionary_flat_storage) {
+    // unsorted pairs are sorted by key and the last duplicate wins
+    variant_dictionary dict(variant_dictionary::container_type{{variant("b"), variant(1)}, {variant("a"), variant(2)}, {variant("b"), variant(3)}});
+    ASSERT_EQ(dict.size(), 2);
+    ASSERT_EQ(dict.begin()->first, variant("a"));
+    ASSERT_EQ(dict.at("b"), variant(3));
+
+    // insertion keeps the storage sorted regardless of order
+    dict["c"] = variant(4);
+    dict[variant(0)] = variant(5);
+    ASSERT_EQ(dict.size(), 4);
+    ASSERT_TRUE(std::is_sorted(dict.begin(), dict.end(), [](const auto &a, const auto &b) { return a.first < b.first; }));
+    ASSERT_EQ(dict.begin()->first, variant(0));
+
+    ASSERT_TRUE(dict.erase("a"));
+    ASSERT_FALSE(dict.contains("a"));
+    ASSERT_THROW((void)dict.at("a"), std::out_of_range);
+
+    // dictionaries built from std::map and from pairs compare equal
+    std::map<variant, variant> map{{variant(0), variant(5)}, {variant("b"), variant(3)}, {variant("c"), variant(4)}};
+    ASSERT_EQ(variant(map), variant(dict));
+}
+
+TEST(variant_test_suite, copy_on_write_payloads) {
+    auto original = variant(std::vector<variant>{variant(1), variant("two")});
+    auto copy = original;
+    ASSERT_EQ(&original.get_array(), &copy.get_array()); // copies share the payload
+
+    // editing a shared payload detaches it first
+    copy.edit_array().push_back(variant(3));
+    ASSERT_NE(&original.get_array(), &copy.get_array());
+    ASSERT_EQ(original.get_array().size(), 2);
+    ASSERT_EQ(copy.get_array().size(), 3);
+
+    // editing an unshared payload happens in place
+    const auto *p_before = &copy.get_array();
+    copy.edit_array()[0] = variant(0);
+    ASSERT_EQ(p_before, &copy.get_array());
+
+    auto text = variant("hello");
+    auto text_copy = text;
+    text_copy.edit_text() += " world";
+    ASSERT_EQ(text.get_text(), "hello");
+    ASSERT_EQ(text_copy.get_text(), "hello world");
+    ASSERT_THROW((void)text.edit_bytes(), std::bad_variant_access);
+}
+
+TEST(variant_test_suite, interned_text) {
+    string_interner interner;
+    auto a = interner.intern("camellia");
+    auto b = interner.intern(text_t("camellia"));
+    auto c = interner.intern("sasanqua");
+    ASSERT_EQ(interner.get_count(), 2);
+
+    // repeated strings share one payload
+    ASSERT_TRUE(a.is_interned());
+    ASSERT_EQ(&a.get_text(), &b.get_text());
+    ASSERT_EQ(a, b);
+    ASSERT_NE(a, c);
+
+    // interned and plain text are interchangeable
+    ASSERT_EQ(a.get_value_type(), variant::TEXT);
+    ASSERT_EQ(a, variant("camellia"));
+    ASSERT_EQ(a.get_text_hash(), algorithm_helper::calc_hash("camellia"));
+    ASSERT_EQ(std::hash<variant>{}(a), std::hash<variant>{}(variant("camellia")));
+
+    // editing detaches from the interner
+    auto d = a;
+    d.edit_text() += "!";
+    ASSERT_FALSE(d.is_interned());
+    ASSERT_EQ(a.get_text(), "camellia");
+
+    // unreferenced strings are swept
+    c = variant();
+    ASSERT_EQ(interner.sweep(), 1);
+    ASSERT_EQ(interner.get_count(), 1);
+}
+
+TEST(variant_test_suite, from_desc_nested_elements) {
+    // vectors inside containers keep their component separators
+    std::vector<variant> vectors = {variant(vector2(1.0F, 2.0F)), variant(vector3(3.0F, 4.0F, 5.0F)), variant(1)};
+    ASSERT_EQ(variant::from_desc("[21,2,33,4,5,I1D]"), variant(vectors));
+
+    // unescaped braces are plain characters in array text
+    std::vector<variant> texts = {variant("a{b"), variant("c:d")};
+    ASSERT_EQ(variant::from_desc("[Ta{b,Tc:d]"), variant(texts));
+    ASSERT_EQ(variant::from_desc(variant(texts).to_desc()), variant(texts));
+
+    // containers nested inside dictionaries
+    std::map<variant, variant> dict{{variant("list"), variant(vectors)}, {variant(vector2(0.5F, 1.5F)), variant("a,b")}};
+    ASSERT_EQ(variant::from_desc(variant(dict).to_desc()), variant(dict));
+
+    // the descriptor does not need to be null-terminated
+    std::string_view view("[I1D,I2D]trailing", 9);
+    ASSERT_EQ(variant::from_desc(view), variant(std::vector<variant>{variant(1), variant(2)}));
+
+    // malformed pairs and elements degrade gracefully
+    ASSERT_EQ(variant::from_desc("{Tkey,I1D:I2D}").get_dictionary().size(), 1);
+    ASSERT_EQ(variant::from_desc("[2abc,I7D]").get_array()[1], variant(7));
+}
+
+TEST(variant_test_suite, to_desc_append) {
+    std::map<variant, variant> dict{{variant("k,ey"), variant(std::vector<variant>{variant("a[b]"), variant(bytes_t{0x0F, 0xA0})})},
+                                    {variant(1), variant(hash_t(0xABCULL))}};
+    auto v = variant(dict);
+
+    // appending writes exactly the same descriptor after the existing content
+    text_t out = "prefix:";
+    v.to_desc(out);
+    ASSERT_EQ(out, "prefix:" + v.to_desc());
+    ASSERT_EQ(v.to_desc(), "{I1D:A0000000000000ABC,Tk\\,ey:[Ta\\[b\\],B0FA0]}");
+
+    out.clear();
+    variant(-2.5F).to_desc(out);
+    variant(vector3(1.0F, 0.5F, -3.0F)).to_desc(out);
+    ASSERT_EQ(out, "N-2.531,0.5,-3");
+}
+
+TEST(variant_test_suite, frame_arena_containers) {
+    frame_arena arena(4096);
+
+    frame_attribute_map attributes(&arena);
+    for (hash_t i = 0; i < 8; i++) {
+        attributes.emplace(i, variant(vector3(1.0F, 2.0F, 3.0F)));
+    }
+    ASSERT_EQ(arena.get_allocation_count(), 8);
+
+    // copies only stay in the arena when the allocator is passed along
+    frame_attribute_map copy(attributes, attributes.get_allocator());
+    ASSERT_EQ(copy.get_allocator().resource(), &arena);
+    ASSERT_EQ(arena.get_allocation_count(), 16);
+
+    // a layer reads its initial values in place and only copies what is written over them
+    const std::map<hash_t, variant> initial{{1, variant(1)}, {2, variant(2)}, {3, variant(3)}};
+    frame_attribute_stack stack(&arena);
+    stack.emplace_back(initial, &arena);
+    ASSERT_EQ(arena.get_allocation_count(), 17);
+    stack.back().set(2, variant(20));
+    stack.back().set(2, variant(21));
+    ASSERT_EQ(arena.get_allocation_count(), 18);
+    ASSERT_EQ(*stack.back().find(1), variant(1));
+    ASSERT_EQ(*stack.back().find(2), variant(21));
+    ASSERT_EQ(stack.back().find(4), nullptr);
+    std::vector<std::pair<hash_t, variant>> merged;
+    stack.back().for_each([&](hash_t h_key, const variant &value) { merged.emplace_back(h_key, value); });
+    ASSERT_EQ(merged, (std::vector<std::pair<hash_t, variant>>{{1, variant(1)}, {2, variant(21)}, {3, variant(3)}}));
+    stack.clear();
+    copy.clear();
+    attributes.clear();
+
+    arena.reset();
+    ASSERT_EQ(arena.get_allocation_count(), 0);
+    ASSERT_EQ(arena.get_bytes_allocated(), 0);
+    ASSERT_EQ(arena.get_spill_count(), 0);
+
+    // a frame that outgrows the buffer spills to the heap once, then the buffer is large enough
+    {
+        frame_attribute_map big(&arena);
+        for (hash_t i = 0; i < 256; i++) {
+            big.emplace(i, variant(static_cast<integer_t>(i)));
+        }
+    }
+    auto used = arena.get_bytes_allocated();
+    arena.reset();
+    ASSERT_EQ(arena.get_spill_count(), 1);
+    ASSERT_GE(arena.get_capacity(), used);
+}
+
+TEST(variant_test_suite, frame_attribute_layer_slots) {
+    frame_arena arena;
+    // keys 1, 3 and 5 are in the layout; 5 has no initial value and 2 is outside the layout
+    const attribute_layout layout({5, 1, 3});
+    const std::map<hash_t, variant> initial{{1, variant(1)}, {2, variant(2)}, {3, variant(3)}};
+    const std::vector<const variant *> initial_slots{&initial.at(1), &initial.at(3), nullptr};
+    frame_attribute_layer layer(initial, &layout, initial_slots, &arena);
+    ASSERT_EQ(layer.find_at(0), &initial.at(1));
+    ASSERT_EQ(layer.find_at(2), nullptr);
+
+    // writes by key land in the slot when the key is in the layout
+    layer.set(3, variant(30));
+    layer.set_at(2, variant(50));
+    layer.set(4, variant(40));
+    ASSERT_EQ(*layer.find_at(1), variant(30));
+    ASSERT_EQ(*layer.find(5), variant(50));
+    ASSERT_EQ(*layer.find(4), variant(40));
+    ASSERT_EQ(*layer.find(2), variant(2));
+
+    std::vector<std::pair<hash_t, attribute_layout::slot_t>> visited;
+    std::vector<variant> values;
+    layer.for_each_slot([&](hash_t h_key, const variant &value, attribute_layout::slot_t slot) {
+        visited.emplace_back(h_key, slot);
+        values.push_back(value);
+    });
+    constexpr auto none = attribute_layout::INVALID_SLOT;
+    ASSERT_EQ(visited, (std::vector<std::pair<hash_t, attribute_layout::slot_t>>{{1, 0}, {2, none}, {3, 1}, {4, none}, {5, 2}}));
+    ASSERT_EQ(values, (std::vector<variant>{variant(1), variant(2), variant(30), variant(40), variant(50)}));
+}
@@ -1,12 +1,21 @@
 ﻿#include "variant.h"
 #include "camellia_typedef.h"
 #include "helper/algorithm_helper.h"
+#include "helper/serialization_helper.h"
 #include "variant_generated.h"
+#include "variant_view.h"
+// XXH3_state_t lives on the stack in variant::get_hash
+#define XXH_STATIC_LINKING_ONLY
+#include "xxhash.h"
+#include <algorithm>
+#include <array>
+#include <charconv>
 #include <cstdio>
 #include <cstring>
 #include <flatbuffers/buffer.h>
-#include <sstream>
+#include <stdexcept>
 #include <string>
+#include <string_view>
 #include <variant>
 #include <vector>
 
@@ -27,12 +36,38 @@
         return false;                                                                                                                                          \
     }                                                                                                                                                          \
                                                                                                                                                                \
-    bool vector##X ::approx_equals(const vector##X &other) const {                                                                                             \
+    bool vector##X ::approx_equals(const vector##X &other) const { return algorithm_helper::approx_equals(dim.data(), other.dim.data(), X); }                  \
+                                                                                                                                                               \
+    vector##X vector##X ::operator+(const vector##X &other) const {                                                                                            \
+        auto res = *this;                                                                                                                                      \
         for (int i = 0; i < X; i++) {                                                                                                                          \
-            if (!algorithm_helper::approx_equals(dim[i], other.dim[i]))                                                                                        \
-                return false;                                                                                                                                  \
+            res.dim[i] += other.dim[i];                                                                                                                        \
         }                                                                                                                                                      \
-        return true;                                                                                                                                           \
+        return res;                                                                                                                                            \
+    }                                                                                                                                                          \
+                                                                                                                                                               \
+    vector##X vector##X ::operator-(const vector##X &other) const {                                                                                            \
+        auto res = *this;                                                                                                                                      \
+        for (int i = 0; i < X; i++) {                                                                                                                          \
+            res.dim[i] -= other.dim[i];                                                                                                                        \
+        }                                                                                                                                                      \
+        return res;                                                                                                                                            \
+    }                                                                                                                                                          \
+                                                                                                                                                               \
+    vector##X vector##X ::operator*(number_t factor) const {                                                                                                   \
+        auto res = *this;                                                                                                                                      \
+        for (int i = 0; i < X; i++) {                                                                                                                          \
+            res.dim[i] *= factor;                                                                                                                              \
+        }                                                                                                                                                      \
+        return res;                                                                                                                                            \
+    }                                                                                                                                                          \
+                                                                                                                                                               \
+    vector##X vector##X ::lerp(const vector##X &from, const vector##X &to, number_t t) {                                                                       \
+        auto res = from;                                                                                                                                       \
+        for (int i = 0; i < X; i++) {                                                                                                                          \
+            res.dim[i] += (to.dim[i] - from.dim[i]) * t;                                                                                                       \
+        }                                                                                                                                                      \
+        return res;                                                                                                                                            \
     }                                                                                                                                                          \
     static_assert(true, "")
 
@@ -85,6 +120,23 @@ void vector4::set_z(number_t z) { dim[2] = z; }
 
 void vector4::set_w(number_t w) { dim[3] = w; }
 
+template <typename T> const T &variant::_get_payload() const { return static_cast<const payload<T> *>(_data.p_payload)->value; }
+
+template <typename T> T &variant::_edit_payload() {
+    auto *p_current = static_cast<payload<T> *>(_data.p_payload);
+    if (p_current->ref_count.load(std::memory_order_acquire) != 1) {
+        // shared with other variants, detach before handing out a mutable reference
+        auto *p_copy = new payload<T>(p_current->value);
+        auto type = _type;
+        _release();
+        _type = type;
+        _data.p_payload = p_copy;
+        return p_copy->value;
+    }
+    p_current->h_content.store(0ULL, std::memory_order_relaxed);
+    return p_current->value;
+}
+
 variant::types variant::get_value_type() const { return _type; }
 
 bool variant::operator==(const variant &other) const {
@@ -92,32 +144,44 @@ bool variant::operator==(const variant &other) const {
         return false;
     }
 
+    if (_is_heap_backed(_type) && _data.p_payload == other._data.p_payload) {
+        return true; // copies sharing one payload
+    }
+
     switch (_type) {
     case VOID:
         return true;
     case BOOLEAN:
-        return std::get<boolean_t>(_data) == std::get<boolean_t>(other._data);
+        return _data.b == other._data.b;
     case INTEGER:
-        return std::get<integer_t>(_data) == std::get<integer_t>(other._data);
+        return _data.i == other._data.i;
     case NUMBER:
-        return std::get<number_t>(_data) == std::get<number_t>(other._data);
+        return _data.n == other._data.n;
     case TEXT:
-    case ERROR:
-        return std::get<text_t>(_data) == std::get<text_t>(other._data);
+    case ERROR: {
+        const auto *p_interner = _data.p_payload->p_interner;
+        if (p_interner != nullptr && p_interner == other._data.p_payload->p_interner) {
+            return false; // one interner never holds the same string twice
+        }
+        if (p_interner != nullptr && other._data.p_payload->p_interner != nullptr && _data.p_payload->h_text != other._data.p_payload->h_text) {
+            return false;
+        }
+        return _get_payload<text_t>() == other._get_payload<text_t>();
+    }
     case VECTOR2:
-        return std::get<vector2>(_data) == std::get<vector2>(other._data);
+        return _data.v2 == other._data.v2;
     case VECTOR3:
-        return std::get<vector3>(_data) == std::get<vector3>(other._data);
+        return _data.v3 == other._data.v3;
     case VECTOR4:
-        return std::get<vector4>(_data) == std::get<vector4>(other._data);
+        return _data.v4 == other._data.v4;
     case BYTES:
-        return std::get<bytes_t>(_data) == std::get<bytes_t>(other._data);
+        return _get_payload<bytes_t>() == other._get_payload<bytes_t>();
     case ARRAY:
-        return std::get<std::vector<variant>>(_data) == std::get<std::vector<variant>>(other._data);
+        return _get_payload<std::vector<variant>>() == other._get_payload<std::vector<variant>>();
     case DICTIONARY:
-        return std::get<std::map<variant, variant>>(_data) == std::get<std::map<variant, variant>>(other._data);
+        return _get_payload<variant_dictionary>() == other._get_payload<variant_dictionary>();
     case HASH:
-        return std::get<hash_t>(_data) == std::get<hash_t>(other._data);
+        return _data.h == other._data.h;
     default: // others
         return false;
     }
@@ -134,24 +198,24 @@ bool variant::operator<(const variant &other) const {
     case VOID:
         return false;
     case BOOLEAN:
-        return static_cast<integer_t>(std::get<boolean_t>(_data)) < static_cast<integer_t>(std::get<boolean_t>(other._data));
+        return static_cast<integer_t>(_data.b) < static_cast<integer_t>(other._data.b);
     case INTEGER:
-        return std::get<integer_t>(_data) < std::get<integer_t>(other._data);
+        return _data.i < other._data.i;
     case NUMBER:
-        return std::get<number_t>(_data) < std::get<number_t>(other._data);
+        return _data.n < other._data.n;
     case TEXT:
     case ERROR:
-        return std::get<text_t>(_data) < std::get<text_t>(other._data);
+        return _get_payload<text_t>() < other._get_payload<text_t>();
     case VECTOR2: {
-        const auto &v1 = std::get<vector2>(_data);
-        const auto &v2 = std::get<vector2>(other._data);
+        const auto &v1 = _data.v2;
+        const auto &v2 = other._data.v2;
         if (v1.get_x() != v2.get_x())
             return v1.get_x() < v2.get_x();
         return v1.get_y() < v2.get_y();
     }
     case VECTOR3: {
-        const auto &v1 = std::get<vector3>(_data);
-        const auto &v2 = std::get<vector3>(other._data);
+        const auto &v1 = _data.v3;
+        const auto &v2 = other._data.v3;
         if (v1.get_x() != v2.get_x()) {
             return v1.get_x() < v2.get_x();
         }
@@ -161,8 +225,8 @@ bool variant::operator<(const variant &other) const {
         return v1.get_z() < v2.get_z();
     }
     case VECTOR4: {
-        const auto &v1 = std::get<vector4>(_data);
-        const auto &v2 = std::get<vector4>(other._data);
+        const auto &v1 = _data.v4;
+        const auto &v2 = other._data.v4;
         if (v1.get_x() != v2.get_x()) {
             return v1.get_x() < v2.get_x();
         }
@@ -175,13 +239,13 @@ bool variant::operator<(const variant &other) const {
         return v1.get_w() < v2.get_w();
     }
     case BYTES:
-        return std::get<bytes_t>(_data) < std::get<bytes_t>(other._data);
+        return _get_payload<bytes_t>() < other._get_payload<bytes_t>();
     case ARRAY:
-        return std::get<std::vector<variant>>(_data) < std::get<std::vector<variant>>(other._data);
+        return _get_payload<std::vector<variant>>() < other._get_payload<std::vector<variant>>();
     case DICTIONARY:
-        return std::get<std::map<variant, variant>>(_data) < std::get<std::map<variant, variant>>(other._data);
+        return _get_payload<variant_dictionary>() < other._get_payload<variant_dictionary>();
     case HASH:
-        return std::get<hash_t>(_data) < std::get<hash_t>(other._data);
+        return _data.h < other._data.h;
     default:
         return false;
     }
@@ -192,148 +256,419 @@ variant &variant::operator=(const variant &v) {
         return *this;
     }
 
+    // v may live inside our own payload (e.g. an array element), so copy before releasing
+    variant copy{v};
+    return *this = std::move(copy);
+}
+
+variant &variant::operator=(variant &&v) noexcept {
+    if (this == &v) {
+        return *this;
+    }
+
+    if (_is_heap_backed(_type)) {
+        _release();
+    }
+    _data = v._data;
     _type = v._type;
+    v._type = VOID;
+    return *this;
+}
+
+variant::variant() : variant(VOID) {}
+
+variant::variant(integer_t i) : _type(INTEGER) { _data.i = i; }
+
+variant::variant(number_t n) : _type(NUMBER) { _data.n = n; }
+
+variant::variant(boolean_t b) : _type(BOOLEAN) { _data.b = b; }
+
+variant::variant(const char *c, boolean_t is_error) : variant(text_t(c), is_error) {}
+
+variant::variant(const text_t &t, boolean_t is_error) : _type(is_error ? ERROR : TEXT) { _data.p_payload = new payload<text_t>(t); }
+
+variant::variant(text_t &&t, boolean_t is_error) : _type(is_error ? ERROR : TEXT) { _data.p_payload = new payload<text_t>(std::move(t)); }
+
+variant::variant(const vector2 &v) : _type(VECTOR2) { _data.v2 = v; }
+
+variant::variant(const vector3 &v) : _type(VECTOR3) { _data.v3 = v; }
+
+variant::variant(const vector4 &v) : _type(VECTOR4) { _data.v4 = v; }
+
+variant::variant(const bytes_t &b) : _type(BYTES) { _data.p_payload = new payload<bytes_t>(b); }
+
+variant::variant(bytes_t &&b) : _type(BYTES) { _data.p_payload = new payload<bytes_t>(std::move(b)); }
+
+variant::variant(const std::vector<variant> &a) : _type(ARRAY) { _data.p_payload = new payload<std::vector<variant>>(a); }
+
+variant::variant(std::vector<variant> &&a) : _type(ARRAY) { _data.p_payload = new payload<std::vector<variant>>(std::move(a)); }
+
+variant::variant(const std::map<variant, variant> &d) : _type(DICTIONARY) { _data.p_payload = new payload<variant_dictionary>(d); }
+
+variant::variant(std::map<variant, variant> &&d) : _type(DICTIONARY) {
+    auto *p_dict = new payload<variant_dictionary>();
+    p_dict->value.reserve(d.size());
+    while (!d.empty()) {
+        auto node = d.extract(d.begin());
+        p_dict->value.insert_or_assign(std::move(node.key()), std::move(node.mapped()));
+    }
+    _data.p_payload = p_dict;
+}
+
+variant::variant(const variant_dictionary &d) : _type(DICTIONARY) { _data.p_payload = new payload<variant_dictionary>(d); }
+
+variant::variant(variant_dictionary &&d) : _type(DICTIONARY) { _data.p_payload = new payload<variant_dictionary>(std::move(d)); }
+
+variant::variant(hash_t h) : _type(HASH) { _data.h = h; }
 
+variant::variant(types t) : _type(t) {
     switch (_type) {
-    case VOID:
-        _data = std::monostate{};
-        break;
     case INTEGER:
-        _data = std::get<integer_t>(v._data);
+        _data.i = integer_t{};
         break;
     case NUMBER:
-        _data = std::get<number_t>(v._data);
+        _data.n = number_t{};
         break;
     case BOOLEAN:
-        _data = std::get<boolean_t>(v._data);
+        _data.b = boolean_t{};
         break;
     case TEXT:
     case ERROR:
-        _data = std::get<text_t>(v._data);
+        _data.p_payload = new payload<text_t>();
         break;
     case VECTOR2:
-        _data = std::get<vector2>(v._data);
+        _data.v2 = vector2(0.0F, 0.0F);
         break;
     case VECTOR3:
-        _data = std::get<vector3>(v._data);
+        _data.v3 = vector3(0.0F, 0.0F, 0.0F);
         break;
     case VECTOR4:
-        _data = std::get<vector4>(v._data);
+        _data.v4 = vector4(0.0F, 0.0F, 0.0F, 0.0F);
         break;
     case BYTES:
-        _data = std::get<bytes_t>(v._data);
+        _data.p_payload = new payload<bytes_t>();
         break;
     case ARRAY:
-        _data = std::get<std::vector<variant>>(v._data);
+        _data.p_payload = new payload<std::vector<variant>>();
         break;
     case DICTIONARY:
-        _data = std::get<std::map<variant, variant>>(v._data);
+        _data.p_payload = new payload<variant_dictionary>();
         break;
-    case HASH:
-        _data = std::get<hash_t>(v._data);
+    default: // VOID and HASH are covered by the zeroed storage
         break;
     }
-    return *this;
 }
 
-variant &variant::operator=(variant &&v) noexcept {
-    _type = v._type;
-    _data = std::move(v._data);
-    v._type = VOID;
-    v._data = std::monostate{};
-    return *this;
-}
-
-variant::variant() : variant(VOID) {}
+variant::variant(variant &&v) noexcept : _data(v._data), _type(v._type) { v._type = VOID; }
 
-variant::variant(integer_t i) : variant(INTEGER) { _data = i; }
-
-variant::variant(number_t n) : variant(NUMBER) { _data = n; }
+void variant::_release() noexcept {
+    if (_data.p_payload->ref_count.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        switch (_type) {
+        case TEXT:
+        case ERROR:
+            delete static_cast<payload<text_t> *>(_data.p_payload);
+            break;
+        case BYTES:
+            delete static_cast<payload<bytes_t> *>(_data.p_payload);
+            break;
+        case ARRAY:
+            delete static_cast<payload<std::vector<variant>> *>(_data.p_payload);
+            break;
+        case DICTIONARY:
+            delete static_cast<payload<variant_dictionary> *>(_data.p_payload);
+            break;
+        default:
+            break;
+        }
+    }
+    _type = VOID;
+}
 
-variant::variant(boolean_t b) : variant(BOOLEAN) { _data = b; }
+text_t &variant::edit_text() {
+    if (_type != TEXT && _type != ERROR) {
+        throw std::bad_variant_access();
+    }
+    return _edit_payload<text_t>();
+}
 
-variant::variant(const char *c, boolean_t is_error) : variant(text_t(c), is_error) {}
+bytes_t &variant::edit_bytes() {
+    if (_type != BYTES) {
+        throw std::bad_variant_access();
+    }
+    return _edit_payload<bytes_t>();
+}
 
-variant::variant(const text_t &t, boolean_t is_error) : variant(is_error ? ERROR : TEXT) { _data = t; }
+std::vector<variant> &variant::edit_array() {
+    if (_type != ARRAY) {
+        throw std::bad_variant_access();
+    }
+    return _edit_payload<std::vector<variant>>();
+}
 
-variant::variant(text_t &&t, boolean_t is_error) : variant(is_error ? ERROR : TEXT) { _data = std::move(t); }
+variant_dictionary &variant::edit_dictionary() {
+    if (_type != DICTIONARY) {
+        throw std::bad_variant_access();
+    }
+    return _edit_payload<variant_dictionary>();
+}
 
-variant::variant(const vector2 &v) : variant(VECTOR2) { _data = v; }
+variant::operator integer_t() const {
+    if (_type != INTEGER) {
+        throw std::bad_variant_access();
+    }
+    return _data.i;
+}
 
-variant::variant(const vector3 &v) : variant(VECTOR3) { _data = v; }
+variant::operator number_t() const {
+    if (_type != NUMBER) {
+        throw std::bad_variant_access();
+    }
+    return _data.n;
+}
 
-variant::variant(const vector4 &v) : variant(VECTOR4) { _data = v; }
+variant::operator boolean_t() const {
+    if (_type != BOOLEAN) {
+        throw std::bad_variant_access();
+    }
+    return _data.b;
+}
 
-variant::variant(const bytes_t &b) : variant(BYTES) { _data = b; }
+variant::operator hash_t() const {
+    if (_type != HASH) {
+        throw std::bad_variant_access();
+    }
+    return _data.h;
+}
 
-variant::variant(bytes_t &&b) : variant(BYTES) { _data = std::move(b); }
+const text_t &variant::get_text() const {
+    if (_type != TEXT && _type != ERROR) {
+        throw std::bad_variant_access();
+    }
+    return _get_payload<text_t>();
+}
 
-variant::variant(const std::vector<variant> &a) : variant(ARRAY) { _data = a; }
+hash_t variant::get_text_hash() const {
+    if (_type != TEXT && _type != ERROR) {
+        throw std::bad_variant_access();
+    }
+    if (_data.p_payload->p_interner != nullptr) {
+        return _data.p_payload->h_text;
+    }
+    return algorithm_helper::calc_hash(_get_payload<text_t>());
+}
 
-variant::variant(std::vector<variant> &&a) : variant(ARRAY) { _data = std::move(a); }
+bool variant::is_interned() const { return (_type == TEXT || _type == ERROR) && _data.p_payload->p_interner != nullptr; }
 
-variant::variant(const std::map<variant, variant> &d) : variant(DICTIONARY) { _data = d; }
+namespace {
+// -0.0 == 0.0, so both must feed the same bits
+number_t canonical_number(number_t n) { return n == 0.0F ? 0.0F : n; }
 
-variant::variant(std::map<variant, variant> &&d) : variant(DICTIONARY) { _data = std::move(d); }
+// Enough for the type tag plus the widest inline value (vector4)
+using inline_hash_buffer = std::array<unsigned char, 1 + sizeof(vector4)>;
 
-variant::variant(hash_t h) : variant(HASH) { _data = h; }
+// Writes the type tag and value bits of a non-container variant, returns the number of bytes used.
+// TEXT/ERROR contribute their text hash, which interned values already carry.
+size_t write_hash_input(const variant &v, inline_hash_buffer &buf) {
+    size_t len = 0;
+    auto put = [&](const auto &value) {
+        std::memcpy(buf.data() + len, &value, sizeof(value));
+        len += sizeof(value);
+    };
+    put(static_cast<char>(v.get_value_type()));
 
-variant::variant(types t) : _type(t) {
-    switch (_type) {
-    case VOID:
-        _data = std::monostate{};
+    switch (v.get_value_type()) {
+    case variant::INTEGER:
+        put(static_cast<integer_t>(v));
         break;
-    case INTEGER:
-        _data = integer_t{};
+    case variant::NUMBER:
+        put(canonical_number(static_cast<number_t>(v)));
         break;
-    case NUMBER:
-        _data = number_t{};
+    case variant::BOOLEAN:
+        put(static_cast<char>(static_cast<boolean_t>(v)));
         break;
-    case BOOLEAN:
-        _data = boolean_t{};
+    case variant::TEXT:
+    case variant::ERROR:
+        put(v.get_text_hash());
         break;
-    case TEXT:
-    case ERROR:
-        _data = text_t{};
+    case variant::VECTOR2:
+        for (const auto d : v.get_vector2().dim) {
+            put(canonical_number(d));
+        }
         break;
-    case VECTOR2:
-        _data = vector2(0.0F, 0.0F);
+    case variant::VECTOR3:
+        for (const auto d : v.get_vector3().dim) {
+            put(canonical_number(d));
+        }
         break;
-    case VECTOR3:
-        _data = vector3(0.0F, 0.0F, 0.0F);
+    case variant::VECTOR4:
+        for (const auto d : v.get_vector4().dim) {
+            put(canonical_number(d));
+        }
         break;
-    case VECTOR4:
-        _data = vector4(0.0F, 0.0F, 0.0F, 0.0F);
+    case variant::HASH:
+        put(static_cast<hash_t>(v));
+        break;
+    default: // VOID
         break;
+    }
+    return len;
+}
+
+// Container elements: inline kinds stream their bits, nested containers stream their own (possibly cached) hash
+void update_hash(XXH3_state_t &state, const variant &v) {
+    const auto type = v.get_value_type();
+    if (type == variant::BYTES || type == variant::ARRAY || type == variant::DICTIONARY) {
+        const auto h = v.get_hash();
+        XXH3_64bits_update(&state, &type, sizeof(type));
+        XXH3_64bits_update(&state, &h, sizeof(h));
+        return;
+    }
+
+    inline_hash_buffer buf;
+    XXH3_64bits_update(&state, buf.data(), write_hash_input(v, buf));
+}
+} // namespace
+
+hash_t variant::get_hash() const {
+    size_t payload_size = 0;
+    switch (_type) {
     case BYTES:
-        _data = bytes_t{};
+        payload_size = _get_payload<bytes_t>().size();
         break;
     case ARRAY:
-        _data = std::vector<variant>{};
+        payload_size = _get_payload<std::vector<variant>>().size();
         break;
     case DICTIONARY:
-        _data = std::map<variant, variant>{};
+        payload_size = _get_payload<variant_dictionary>().size();
         break;
-    case HASH:
-        _data = hash_t{};
+    default: {
+        inline_hash_buffer buf;
+        return XXH3_64bits_withSeed(buf.data(), write_hash_input(*this, buf), algorithm_helper::XXHASH_SEED);
+    }
+    }
+
+    // Only shared payloads are immutable, a unique one may still be edited through an outstanding reference
+    const bool cacheable = payload_size >= HASH_CACHE_MIN_SIZE && _data.p_payload->ref_count.load(std::memory_order_acquire) > 1;
+    if (cacheable) {
+        if (const auto h_cached = _data.p_payload->h_content.load(std::memory_order_relaxed); h_cached != 0ULL) {
+            return h_cached;
+        }
+    }
+
+    XXH3_state_t state;
+    XXH3_64bits_reset_withSeed(&state, algorithm_helper::XXHASH_SEED);
+    XXH3_64bits_update(&state, &_type, sizeof(_type));
+    switch (_type) {
+    case BYTES: {
+        const auto &bytes = _get_payload<bytes_t>();
+        XXH3_64bits_update(&state, bytes.data(), bytes.size());
+        break;
+    }
+    case ARRAY:
+        for (const auto &element : _get_payload<std::vector<variant>>()) {
+            update_hash(state, element);
+        }
+        break;
+    default: // DICTIONARY
+        for (const auto &[key, value] : _get_payload<variant_dictionary>()) {
+            update_hash(state, key);
+            update_hash(state, value);
+        }
         break;
     }
-}
 
-variant::variant(variant &&v) noexcept : _type(v._type), _data(std::move(v._data)) {
-    v._type = VOID;
-    v._data = std::monostate{};
+    const auto h = XXH3_64bits_digest(&state);
+    if (cacheable) {
+        _data.p_payload->h_content.store(h, std::memory_order_relaxed);
+    }
+    return h;
 }
 
-variant::operator integer_t() const { return std::get<integer_t>(_data); }
+namespace {
+bool is_numeric(variant::types type) { return type == variant::INTEGER || type == variant::NUMBER; }
+} // namespace
 
-variant::operator number_t() const { return std::get<number_t>(_data); }
+variant variant::add(const variant &other) const {
+    if (_type == INTEGER && other._type == INTEGER) {
+        return {_data.i + other._data.i};
+    }
+    if (is_numeric(_type) && is_numeric(other._type)) {
+        return {(_type == NUMBER ? _data.n : (number_t)_data.i) + (other._type == NUMBER ? other._data.n : (number_t)other._data.i)};
+    }
+    if (_type != other._type) {
+        throw std::bad_variant_access();
+    }
+    switch (_type) {
+    case VECTOR2:
+        return {_data.v2 + other._data.v2};
+    case VECTOR3:
+        return {_data.v3 + other._data.v3};
+    case VECTOR4:
+        return {_data.v4 + other._data.v4};
+    default:
+        throw std::bad_variant_access();
+    }
+}
 
-variant::operator boolean_t() const { return std::get<boolean_t>(_data); }
+variant variant::subtract(const variant &other) const {
+    if (_type == INTEGER && other._type == INTEGER) {
+        return {_data.i - other._data.i};
+    }
+    if (is_numeric(_type) && is_numeric(other._type)) {
+        return {(_type == NUMBER ? _data.n : (number_t)_data.i) - (other._type == NUMBER ? other._data.n : (number_t)other._data.i)};
+    }
+    if (_type != other._type) {
+        throw std::bad_variant_access();
+    }
+    switch (_type) {
+    case VECTOR2:
+        return {_data.v2 - other._data.v2};
+    case VECTOR3:
+        return {_data.v3 - other._data.v3};
+    case VECTOR4:
+        return {_data.v4 - other._data.v4};
+    default:
+        throw std::bad_variant_access();
+    }
+}
 
-variant::operator hash_t() const { return std::get<hash_t>(_data); }
+variant variant::scale(number_t factor) const {
+    switch (_type) {
+    case INTEGER:
+        return {(number_t)_data.i * factor};
+    case NUMBER:
+        return {_data.n * factor};
+    case VECTOR2:
+        return {_data.v2 * factor};
+    case VECTOR3:
+        return {_data.v3 * factor};
+    case VECTOR4:
+        return {_data.v4 * factor};
+    default:
+        throw std::bad_variant_access();
+    }
+}
 
-const text_t &variant::get_text() const { return std::get<text_t>(_data); }
+variant variant::lerp(const variant &from, const variant &to, number_t t) {
+    if (is_numeric(from._type) && is_numeric(to._type)) {
+        auto a = from._type == NUMBER ? from._data.n : (number_t)from._data.i;
+        auto b = to._type == NUMBER ? to._data.n : (number_t)to._data.i;
+        return {a + (b - a) * t};
+    }
+    if (from._type != to._type) {
+        throw std::bad_variant_access();
+    }
+    switch (from._type) {
+    case VECTOR2:
+        return {vector2::lerp(from._data.v2, to._data.v2, t)};
+    case VECTOR3:
+        return {vector3::lerp(from._data.v3, to._data.v3, t)};
+    case VECTOR4:
+        return {vector4::lerp(from._data.v4, to._data.v4, t)};
+    default:
+        throw std::bad_variant_access();
+    }
+}
 
 bool variant::approx_equals(const variant &other) const {
     switch (_type) {
@@ -342,38 +677,40 @@ bool variant::approx_equals(const variant &other) const {
         if (other._type != NUMBER && other._type != INTEGER) {
             return *this == other;
         }
-        auto a = _type == NUMBER ? std::get<number_t>(_data) : (number_t)std::get<integer_t>(_data);
-        auto b = other._type == NUMBER ? std::get<number_t>(other._data) : (number_t)std::get<integer_t>(other._data);
+        auto a = _type == NUMBER ? _data.n : (number_t)_data.i;
+        auto b = other._type == NUMBER ? other._data.n : (number_t)other._data.i;
         return algorithm_helper::approx_equals(a, b);
     }
     case VECTOR2: {
         if (other._type != VECTOR2) {
             return *this == other;
         }
-        return std::get<vector2>(_data).approx_equals(std::get<vector2>(other._data));
+        return _data.v2.approx_equals(other._data.v2);
     }
     case VECTOR3: {
         if (other._type != VECTOR3) {
             return *this == other;
         }
-        return std::get<vector3>(_data).approx_equals(std::get<vector3>(other._data));
+        return _data.v3.approx_equals(other._data.v3);
     }
     case VECTOR4: {
         if (other._type != VECTOR4) {
             return *this == other;
         }
-        return std::get<vector4>(_data).approx_equals(std::get<vector4>(other._data));
+        return _data.v4.approx_equals(other._data.v4);
     }
     case ARRAY: {
         if (other._type != ARRAY) {
             return *this == other;
         }
 
-        if (std::get<std::vector<variant>>(_data).size() != std::get<std::vector<variant>>(other._data).size()) {
+        const auto &arr1 = _get_payload<std::vector<variant>>();
+        const auto &arr2 = other._get_payload<std::vector<variant>>();
+        if (arr1.size() != arr2.size()) {
             return false;
         }
-        for (size_t i = 0; i < std::get<std::vector<variant>>(_data).size(); i++) {
-            if (!std::get<std::vector<variant>>(_data)[i].approx_equals(std::get<std::vector<variant>>(other._data)[i])) {
+        for (size_t i = 0; i < arr1.size(); i++) {
+            if (!arr1[i].approx_equals(arr2[i])) {
                 return false;
             }
         }
@@ -384,8 +721,8 @@ bool variant::approx_equals(const variant &other) const {
             return *this == other;
         }
 
-        const auto &dict1 = std::get<std::map<variant, variant>>(_data);
-        const auto &dict2 = std::get<std::map<variant, variant>>(other._data);
+        const auto &dict1 = _get_payload<variant_dictionary>();
+        const auto &dict2 = other._get_payload<variant_dictionary>();
 
         if (dict1.size() != dict2.size()) {
             return false;
@@ -404,555 +741,461 @@ bool variant::approx_equals(const variant &other) const {
     }
 }
 
-const vector2 &variant::get_vector2() const { return std::get<vector2>(_data); }
-
-const vector3 &variant::get_vector3() const { return std::get<vector3>(_data); }
+const vector2 &variant::get_vector2() const {
+    if (_type != VECTOR2) {
+        throw std::bad_variant_access();
+    }
+    return _data.v2;
+}
 
-const vector4 &variant::get_vector4() const { return std::get<vector4>(_data); }
+const vector3 &variant::get_vector3() const {
+    if (_type != VECTOR3) {
+        throw std::bad_variant_access();
+    }
+    return _data.v3;
+}
 
-const bytes_t &variant::get_bytes() const { return std::get<bytes_t>(_data); }
+const vector4 &variant::get_vector4() const {
+    if (_type != VECTOR4) {
+        throw std::bad_variant_access();
+    }
+    return _data.v4;
+}
 
-const std::vector<variant> &variant::get_array() const { return std::get<std::vector<variant>>(_data); }
+const bytes_t &variant::get_bytes() const {
+    if (_type != BYTES) {
+        throw std::bad_variant_access();
+    }
+    return _get_payload<bytes_t>();
+}
 
-const std::map<variant, variant> &variant::get_dictionary() const { return std::get<std::map<variant, variant>>(_data); }
+const std::vector<variant> &variant::get_array() const {
+    if (_type != ARRAY) {
+        throw std::bad_variant_access();
+    }
+    return _get_payload<std::vector<variant>>();
+}
 
-variant variant::from_desc(const text_t &descriptor) {
-    if (descriptor.empty()) {
-        return {}; // VOID
+const variant_dictionary &variant::get_dictionary() const {
+    if (_type != DICTIONARY) {
+        throw std::bad_variant_access();
     }
+    return _get_payload<variant_dictionary>();
+}
 
-    char type_char = descriptor[0];
+namespace {
+// Recursive-descent reader for descriptors. Containers are built in a single pass and nested elements are parsed
+// in place, so no intermediate substrings or unescaped copies are made.
+class descriptor_parser {
+public:
+    explicit descriptor_parser(std::string_view source) : _source(source) {}
 
-    switch (type_char) {
-    case VOID_PREFIX: // VOID
-        return {};
+    variant parse() { return _parse_value(context::ROOT); }
 
-    case INTEGER_PREFIX: { // INTEGER
-        if (descriptor.size() <= 1) {
-            return {0};
-        }
+private:
+    // Which characters end a scalar or text element depends on the enclosing container
+    enum class context : char { ROOT, ARRAY, DICTIONARY };
 
-        // Find base suffix (D=decimal, H=hex, O=octal, B=binary)
-        char base_suffix = descriptor.back();
+    std::string_view _source;
+    size_t _pos{0};
 
-        int base = 10;
-        size_t len{descriptor.size() - 2};
-        switch (base_suffix) {
-        case 'H':
-            base = 16;
-            break;
-        case 'O':
-            base = 8;
-            break;
-        case 'B':
-            base = 2;
-            break;
-        case 'D':
-            break;
-        default:
-            // No suffix, assume entire content is decimal
-            len = descriptor.size() - 1;
-            break;
-        }
+    [[nodiscard]] bool _at_end() const { return _pos >= _source.size(); }
 
-        try {
-            return {static_cast<integer_t>(std::stol(descriptor.substr(1, len), nullptr, base))};
-        } catch (...) {
-            return {0};
+    [[nodiscard]] static bool _is_terminator(char c, context ctx) {
+        switch (ctx) {
+        case context::ARRAY:
+            return c == variant::ARRAY_SEPARATOR || c == variant::ARRAY_SUFFIX;
+        case context::DICTIONARY:
+            return c == variant::DICTIONARY_SEPARATOR || c == variant::DICTIONARY_KEY_VALUE_SEPARATOR || c == variant::DICTIONARY_SUFFIX;
+        default:
+            return false;
         }
     }
 
-    case NUMBER_PREFIX: { // NUMBER (floating point)
-        try {
-            return {std::stof(descriptor.substr(1))};
-        } catch (...) {
-            return {0.0F};
+    // Consumes everything up to the next terminator of the enclosing container (or the end at root level)
+    std::string_view _take_token(context ctx) {
+        auto start = _pos;
+        while (!_at_end() && !_is_terminator(_source[_pos], ctx)) {
+            _pos++;
         }
+        return _source.substr(start, _pos - start);
     }
 
-    case BOOLEAN_PREFIX: { // BOOLEAN
-        if (descriptor.size() <= 1 || descriptor[1] == '0' || descriptor[1] == 'F') {
-            return {false};
-        } else {
-            return {true};
+    text_t _take_text(context ctx) {
+        if (ctx == context::ROOT) {
+            // Top-level text is taken verbatim
+            auto text = _source.substr(_pos);
+            _pos = _source.size();
+            return text_t(text);
         }
-    }
-
-    case TEXT_PREFIX: // TEXT
-        return {descriptor.substr(1)};
 
-    case ERROR_PREFIX: // ERROR
-        return {descriptor.substr(1), true};
-
-    case VECTOR2_PREFIX: { // VECTOR2
-        // Format: "2x,y"
-        std::istringstream iss(descriptor);
-        iss.seekg(1);
-        vector2 v{0.0, 0.0};
-        char comma{'Z'};
-        iss >> v.dim[0] >> comma >> v.dim[1];
-        return {v};
+        text_t text;
+        auto start = _pos;
+        while (!_at_end() && !_is_terminator(_source[_pos], ctx)) {
+            if (_source[_pos] == variant::ESCAPE_CHAR) {
+                text.append(_source.substr(start, _pos - start));
+                _pos++;
+                start = _pos;
+                if (_at_end()) {
+                    break;
+                }
+            }
+            _pos++;
+        }
+        text.append(_source.substr(start, _pos - start));
+        return text;
     }
 
-    case VECTOR3_PREFIX: { // VECTOR3
-        // Format: "3x,y,z"
-        std::istringstream iss(descriptor);
-        iss.seekg(1);
-        vector3 v{0.0, 0.0, 0.0};
-        char comma{'Z'};
-        iss >> v.dim[0] >> comma >> v.dim[1] >> comma >> v.dim[2];
-        return {v};
-    }
+    variant _parse_value(context ctx) {
+        if (_at_end() || _is_terminator(_source[_pos], ctx)) {
+            return {}; // VOID
+        }
 
-    case VECTOR4_PREFIX: { // VECTOR4
-        // Format: "4x,y,z,w"
-        std::istringstream iss(descriptor);
-        iss.seekg(1);
-        vector4 v{0.0, 0.0, 0.0, 0.0};
-        char comma{'Z'};
-        iss >> v.dim[0] >> comma >> v.dim[1] >> comma >> v.dim[2] >> comma >> v.dim[3];
-        return {v};
+        switch (_source[_pos++]) {
+        case variant::VOID_PREFIX:
+            (void)_take_token(ctx);
+            return {};
+        case variant::INTEGER_PREFIX:
+            return {_parse_integer(_take_token(ctx))};
+        case variant::NUMBER_PREFIX:
+            return {_parse_number(_take_token(ctx))};
+        case variant::BOOLEAN_PREFIX: {
+            auto token = _take_token(ctx);
+            return {!token.empty() && token[0] != '0' && token[0] != 'F'};
+        }
+        case variant::TEXT_PREFIX:
+            return {_take_text(ctx)};
+        case variant::ERROR_PREFIX:
+            return {_take_text(ctx), true};
+        case variant::VECTOR2_PREFIX: {
+            auto dim = _parse_components<2>(ctx);
+            return {vector2(dim[0], dim[1])};
+        }
+        case variant::VECTOR3_PREFIX: {
+            auto dim = _parse_components<3>(ctx);
+            return {vector3(dim[0], dim[1], dim[2])};
+        }
+        case variant::VECTOR4_PREFIX: {
+            auto dim = _parse_components<4>(ctx);
+            return {vector4(dim[0], dim[1], dim[2], dim[3])};
+        }
+        case variant::BYTES_PREFIX:
+            return {_parse_bytes(_take_token(ctx))};
+        case variant::ARRAY_PREFIX:
+            return _parse_array(ctx);
+        case variant::DICTIONARY_PREFIX:
+            return _parse_dictionary(ctx);
+        case variant::HASH_PREFIX:
+            // The ':' of the A:name form belongs to the value, inside a dictionary it is not a key-value separator
+            if (!_at_end() && _source[_pos] == ':') {
+                _pos++;
+                return {algorithm_helper::calc_hash(_take_token(ctx))};
+            }
+            return {_parse_hash(_take_token(ctx))};
+        default:
+            (void)_take_token(ctx);
+            return {}; // Unknown type, return VOID
+        }
     }
 
-    case BYTES_PREFIX: { // BYTES
-        // Hex-encoded bytes
-        bytes_t bytes;
-        for (size_t i = 1; i < descriptor.size(); i += 2) {
-            if (i + 1 < descriptor.size()) {
-                text_t hex_byte = descriptor.substr(i, 2);
-                try {
-                    auto byte = static_cast<unsigned char>(std::stoul(hex_byte, nullptr, 16));
-                    bytes.push_back(byte);
-                } catch (...) {
-                    // Skip invalid hex
-                    bytes.push_back(0);
+    template <size_t N> std::array<number_t, N> _parse_components(context ctx) {
+        std::array<number_t, N> dim{};
+        for (size_t i = 0; i < N; i++) {
+            if (i > 0) {
+                if (_at_end() || _source[_pos] != variant::VECTOR_SEPARATOR) {
+                    break;
                 }
+                _pos++;
+            }
+
+            const auto *p_begin = _source.data() + _pos;
+            if (!_at_end() && *p_begin == '+') {
+                p_begin++;
             }
+            auto [p_end, ec] = std::from_chars(p_begin, _source.data() + _source.size(), dim[i]);
+            if (ec != std::errc()) {
+                dim[i] = 0.0F;
+                break;
+            }
+            _pos = p_end - _source.data();
         }
-        return {bytes};
+        (void)_take_token(ctx); // skip malformed leftovers
+        return dim;
     }
 
-    case ARRAY_PREFIX: { // ARRAY - special case where '[' is the type indicator
-        // Parse array: [elem1,elem2,elem3]
-        if (descriptor.back() != ARRAY_SUFFIX) {
+    variant _parse_array(context ctx) {
+        if (ctx == context::ROOT && _source.back() != variant::ARRAY_SUFFIX) {
             return {std::vector<variant>()};
         }
 
         std::vector<variant> elements;
-        if (descriptor.size() <= 2) {
-            return {elements};
+        if (!_at_end() && _source[_pos] == variant::ARRAY_SUFFIX) {
+            _pos++;
+            return {std::move(elements)};
         }
 
-        // Parse comma-separated elements with escape handling
-        size_t start = 1;
-        int bracket_level = 0;
-        int brace_level = 0;
-        bool escaped = false;
-
-        for (size_t i = start; i <= descriptor.length() - 1; ++i) {
-            char c = (i < descriptor.length() - 1) ? descriptor[i] : ARRAY_SEPARATOR; // Treat end as comma
-
-            if (escaped) {
-                escaped = false;
-                continue;
+        while (!_at_end()) {
+            elements.push_back(_parse_value(context::ARRAY));
+            if (_at_end()) {
+                break;
             }
-
-            if (c == ESCAPE_CHAR) {
-                escaped = true;
-                continue;
-            }
-
-            if (c == ARRAY_PREFIX) {
-                bracket_level++;
-            } else if (c == ARRAY_SUFFIX) {
-                bracket_level--;
-            } else if (c == DICTIONARY_PREFIX) {
-                brace_level++;
-            } else if (c == DICTIONARY_SUFFIX) {
-                brace_level--;
-            } else if (c == ARRAY_SEPARATOR && bracket_level == 0 && brace_level == 0) {
-                // Found a separator at top level
-                text_t element_desc = descriptor.substr(start, i - start);
-
-                text_t unescaped;
-                if (element_desc.size() >= 1 && (element_desc[0] == TEXT_PREFIX || element_desc[0] == ERROR_PREFIX)) {
-                    // Unescape the element descriptor
-                    bool esc = false;
-                    for (char ch : element_desc) {
-                        if (esc) {
-                            unescaped += ch;
-                            esc = false;
-                        } else if (ch == ESCAPE_CHAR) {
-                            esc = true;
-                        } else {
-                            unescaped += ch;
-                        }
-                    }
-                } else {
-                    unescaped = element_desc;
-                }
-
-                elements.push_back(from_desc(unescaped)); // TODO: optimize this
-                start = i + 1;
+            if (_source[_pos++] == variant::ARRAY_SUFFIX) {
+                break;
             }
         }
-
-        return {elements};
+        return {std::move(elements)};
     }
 
-    case DICTIONARY_PREFIX: { // DICTIONARY - special case where '{' is the type indicator
-        // Parse dictionary: {key1:value1,key2:value2}
-        if (descriptor.back() != DICTIONARY_SUFFIX) {
-            return {std::map<variant, variant>()};
+    variant _parse_dictionary(context ctx) {
+        if (ctx == context::ROOT && _source.back() != variant::DICTIONARY_SUFFIX) {
+            return {variant_dictionary()};
         }
 
-        std::map<variant, variant> dict;
-        if (descriptor.size() <= 2) {
-            return {dict};
+        variant_dictionary::container_type pairs;
+        if (!_at_end() && _source[_pos] == variant::DICTIONARY_SUFFIX) {
+            _pos++;
+            return {variant_dictionary()};
         }
 
-        // Parse comma-separated key:value pairs with escape handling
-        size_t start = 1;
-        int bracket_level = 0;
-        int brace_level = 0;
-        bool escaped = false;
-
-        for (size_t i = start; i <= descriptor.length() - 1; ++i) {
-            char c = (i < descriptor.length() - 1) ? descriptor[i] : DICTIONARY_SEPARATOR; // Treat end as comma
-
-            if (escaped) {
-                escaped = false;
-                continue;
+        while (!_at_end()) {
+            auto key = _parse_value(context::DICTIONARY);
+            if (!_at_end() && _source[_pos] == variant::DICTIONARY_KEY_VALUE_SEPARATOR) {
+                _pos++;
+                pairs.emplace_back(std::move(key), _parse_value(context::DICTIONARY));
             }
-
-            if (c == ESCAPE_CHAR) {
-                escaped = true;
-                continue;
+            // pairs without a key-value separator are dropped, skip to the next separator
+            while (!_at_end() && _source[_pos] == variant::DICTIONARY_KEY_VALUE_SEPARATOR) {
+                _pos++;
+                (void)_parse_value(context::DICTIONARY);
             }
+            if (_at_end()) {
+                break;
+            }
+            if (_source[_pos++] == variant::DICTIONARY_SUFFIX) {
+                break;
+            }
+        }
+        return {variant_dictionary(std::move(pairs))};
+    }
 
-            if (c == ARRAY_PREFIX) {
-                bracket_level++;
-            } else if (c == ARRAY_SUFFIX) {
-                bracket_level--;
-            } else if (c == DICTIONARY_PREFIX) {
-                brace_level++;
-            } else if (c == DICTIONARY_SUFFIX) {
-                brace_level--;
-            } else if (c == DICTIONARY_SEPARATOR && bracket_level == 0 && brace_level == 0) {
-                // Found a separator at top level
-                text_t pair_desc = descriptor.substr(start, i - start);
-
-                // Find the key:value separator at top level
-                size_t colon_pos = text_t::npos;
-                int pair_bracket_level = 0;
-                int pair_brace_level = 0;
-                bool pair_escaped = false;
-                for (size_t j = 0; j < pair_desc.size(); ++j) {
-                    if (pair_escaped) {
-                        pair_escaped = false;
-                        continue;
-                    }
-                    if (pair_desc[j] == ESCAPE_CHAR) {
-                        pair_escaped = true;
-                        continue;
-                    }
-                    if (pair_desc[j] == ARRAY_PREFIX) {
-                        pair_bracket_level++;
-                    } else if (pair_desc[j] == ARRAY_SUFFIX) {
-                        pair_bracket_level--;
-                    } else if (pair_desc[j] == DICTIONARY_PREFIX) {
-                        pair_brace_level++;
-                    } else if (pair_desc[j] == DICTIONARY_SUFFIX) {
-                        pair_brace_level--;
-                    } else if (pair_desc[j] == DICTIONARY_KEY_VALUE_SEPARATOR && pair_bracket_level == 0 && pair_brace_level == 0) {
-                        colon_pos = j;
-                        break;
-                    }
-                }
-
-                if (colon_pos != text_t::npos) {
-                    text_t key_desc = pair_desc.substr(0, colon_pos);
-                    text_t value_desc = pair_desc.substr(colon_pos + 1);
-
-                    // Unescape if needed
-                    auto unescape_if_text = [](const text_t &desc) -> text_t {
-                        if (desc.size() >= 1 && (desc[0] == TEXT_PREFIX || desc[0] == ERROR_PREFIX)) {
-                            text_t unescaped;
-                            bool esc = false;
-                            for (char ch : desc) {
-                                if (esc) {
-                                    unescaped += ch;
-                                    esc = false;
-                                } else if (ch == ESCAPE_CHAR) {
-                                    esc = true;
-                                } else {
-                                    unescaped += ch;
-                                }
-                            }
-                            return unescaped;
-                        }
-                        return desc;
-                    };
-
-                    variant key = from_desc(unescape_if_text(key_desc));
-                    variant value = from_desc(unescape_if_text(value_desc));
-                    dict[key] = value;
-                }
-
-                start = i + 1;
+    static integer_t _parse_integer(std::string_view token) {
+        // Optional base suffix (D=decimal, H=hex, O=octal, B=binary), otherwise decimal
+        int base = 10;
+        if (!token.empty()) {
+            switch (token.back()) {
+            case variant::INTEGER_HEXADECIMAL_SUFFIX:
+                base = 16;
+                token.remove_suffix(1);
+                break;
+            case variant::INTEGER_OCTAL_SUFFIX:
+                base = 8;
+                token.remove_suffix(1);
+                break;
+            case variant::INTEGER_BINARY_SUFFIX:
+                base = 2;
+                token.remove_suffix(1);
+                break;
+            case variant::INTEGER_DECIMAL_SUFFIX:
+                token.remove_suffix(1);
+                break;
+            default:
+                break;
             }
         }
+        if (!token.empty() && token[0] == '+') {
+            token.remove_prefix(1);
+        }
 
-        return {dict};
+        // Parsed as 64 bits and truncated, so full-width hex literals such as IFFFFFFFFH still map to 32-bit patterns
+        int64_t value = 0;
+        if (std::from_chars(token.data(), token.data() + token.size(), value, base).ec != std::errc()) {
+            return 0;
+        }
+        return static_cast<integer_t>(value);
     }
 
-    case HASH_PREFIX: { // HASH
-        try {
-            if (descriptor.size() <= 1) {
-                return {hash_t(0)};
-            }
+    static number_t _parse_number(std::string_view token) {
+        if (!token.empty() && token[0] == '+') {
+            token.remove_prefix(1);
+        }
+        number_t value = 0.0F;
+        if (std::from_chars(token.data(), token.data() + token.size(), value).ec != std::errc()) {
+            return 0.0F;
+        }
+        return value;
+    }
 
-            if (descriptor[1] == ':') {
-                hash_t hash = algorithm_helper::calc_hash(descriptor.substr(2));
-                return {hash};
+    static bytes_t _parse_bytes(std::string_view token) {
+        bytes_t bytes;
+        bytes.reserve(token.size() / 2);
+        for (size_t i = 0; i + 1 < token.size(); i += 2) {
+            unsigned int byte = 0U;
+            if (std::from_chars(token.data() + i, token.data() + i + 2, byte, 16).ec != std::errc()) {
+                byte = 0U; // invalid hex
             }
+            bytes.push_back(static_cast<uint8_t>(byte));
+        }
+        return bytes;
+    }
 
-            hash_t hash = std::stoull(descriptor.substr(1), nullptr, 16);
-            return {hash};
-        } catch (...) {
-            return {hash_t(0)};
+    static hash_t _parse_hash(std::string_view token) {
+        hash_t hash = 0ULL;
+        if (std::from_chars(token.data(), token.data() + token.size(), hash, 16).ec != std::errc()) {
+            return 0ULL;
         }
+        return hash;
     }
+};
+} // namespace
 
-    default:
-        return {}; // Unknown type, return VOID
+variant variant::from_desc(std::string_view descriptor) { return descriptor_parser(descriptor).parse(); }
+
+text_t variant::to_desc() const {
+    text_t result;
+    to_desc(result);
+    return result;
+}
+
+void variant::to_desc(text_t &out) const { _write_desc(out, {}); }
+
+namespace {
+constexpr std::string_view ARRAY_ESCAPED_CHARS{"\\,[]"};
+constexpr std::string_view DICTIONARY_ESCAPED_CHARS{"\\,:{}[]"};
+constexpr std::array<char, 16> HEX_DIGITS{'0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'A', 'B', 'C', 'D', 'E', 'F'};
+
+template <typename T> void append_chars(text_t &out, T value) {
+    std::array<char, 32> buffer{};
+    auto [p_end, ec] = std::to_chars(buffer.data(), buffer.data() + buffer.size(), value);
+    out.append(buffer.data(), p_end);
+}
+
+void append_components(text_t &out, const number_t *p_dim, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        if (i > 0) {
+            out += variant::VECTOR_SEPARATOR;
+        }
+        append_chars(out, p_dim[i]);
     }
 }
+} // namespace
 
-text_t variant::to_desc() const {
+void variant::_write_desc(text_t &out, std::string_view escaped_chars) const {
     switch (_type) {
     case VOID:
-        return text_t{VOID_PREFIX};
-
-    case INTEGER: {
-        integer_t value = std::get<integer_t>(_data);
-        return std::format("{}{}{}", INTEGER_PREFIX, value, INTEGER_DECIMAL_SUFFIX);
-    }
+        out += VOID_PREFIX;
+        break;
 
-    case NUMBER: {
-        number_t value = std::get<number_t>(_data);
-        return std::format("{}{}", NUMBER_PREFIX, value);
-    }
+    case INTEGER:
+        out += INTEGER_PREFIX;
+        append_chars(out, _data.i);
+        out += INTEGER_DECIMAL_SUFFIX;
+        break;
 
-    case BOOLEAN: {
-        boolean_t value = std::get<boolean_t>(_data);
-        return std::format("{}{}", BOOLEAN_PREFIX, value ? "1" : "0");
-    }
+    case NUMBER:
+        out += NUMBER_PREFIX;
+        append_chars(out, _data.n);
+        break;
 
-    case TEXT: {
-        const auto &value = std::get<text_t>(_data);
-        return std::format("{}{}", TEXT_PREFIX, value);
-    }
+    case BOOLEAN:
+        out += BOOLEAN_PREFIX;
+        out += _data.b ? '1' : '0';
+        break;
 
+    case TEXT:
     case ERROR: {
-        const auto &value = std::get<text_t>(_data);
-        return std::format("{}{}", ERROR_PREFIX, value);
-    }
+        out += _type == TEXT ? TEXT_PREFIX : ERROR_PREFIX;
+        const auto &value = _get_payload<text_t>();
+        if (escaped_chars.empty()) {
+            out += value;
+            break;
+        }
 
-    case VECTOR2: {
-        const auto &v = std::get<vector2>(_data);
-        return std::format("{}{}{}{}", VECTOR2_PREFIX, v.get_x(), VECTOR_SEPARATOR, v.get_y());
+        // Escape characters that would otherwise end the element inside the enclosing container
+        size_t start = 0;
+        for (size_t i = 0; i < value.size(); i++) {
+            if (escaped_chars.find(value[i]) != std::string_view::npos) {
+                out.append(value, start, i - start);
+                out += ESCAPE_CHAR;
+                start = i;
+            }
+        }
+        out.append(value, start);
+        break;
     }
 
-    case VECTOR3: {
-        const auto &v = std::get<vector3>(_data);
-        return std::format("{}{}{}{}{}{}", VECTOR3_PREFIX, v.get_x(), VECTOR_SEPARATOR, v.get_y(), VECTOR_SEPARATOR, v.get_z());
-    }
+    case VECTOR2:
+        out += VECTOR2_PREFIX;
+        append_components(out, _data.v2.dim.data(), 2);
+        break;
 
-    case VECTOR4: {
-        const auto &v = std::get<vector4>(_data);
-        return std::format("{}{}{}{}{}{}{}{}", VECTOR4_PREFIX, v.get_x(), VECTOR_SEPARATOR, v.get_y(), VECTOR_SEPARATOR, v.get_z(), VECTOR_SEPARATOR,
-                           v.get_w());
-    }
+    case VECTOR3:
+        out += VECTOR3_PREFIX;
+        append_components(out, _data.v3.dim.data(), 3);
+        break;
+
+    case VECTOR4:
+        out += VECTOR4_PREFIX;
+        append_components(out, _data.v4.dim.data(), 4);
+        break;
 
     case BYTES: {
-        const auto &bytes = std::get<bytes_t>(_data);
-        text_t result;
-        result.reserve((bytes.size() * 2) + 1);
-        result += BYTES_PREFIX;
-        for (unsigned char byte : bytes) {
-            result += std::format("{:02X}", byte);
+        const auto &bytes = _get_payload<bytes_t>();
+        out.reserve(out.size() + (bytes.size() * 2) + 1);
+        out += BYTES_PREFIX;
+        for (auto byte : bytes) {
+            out += HEX_DIGITS[byte >> 4U];
+            out += HEX_DIGITS[byte & 0xFU];
         }
-        return result;
+        break;
     }
 
     case ARRAY: {
-        const auto &elements = std::get<std::vector<variant>>(_data);
-        text_t result{ARRAY_PREFIX};
-
+        const auto &elements = _get_payload<std::vector<variant>>();
+        out += ARRAY_PREFIX;
         for (size_t i = 0; i < elements.size(); ++i) {
             if (i > 0) {
-                result += ARRAY_SEPARATOR;
-            }
-
-            auto element_desc = elements[i].to_desc();
-
-            if (element_desc.size() >= 1 && (element_desc[0] == TEXT_PREFIX || element_desc[0] == ERROR_PREFIX)) {
-                // Escape special characters in the element string descriptor
-                auto escaped = text_t();
-                escaped.reserve(element_desc.size());
-                for (char c : element_desc) {
-                    if (c == ESCAPE_CHAR || c == ARRAY_SEPARATOR || c == ARRAY_PREFIX || c == ARRAY_SUFFIX) {
-                        escaped += ESCAPE_CHAR;
-                    }
-                    escaped += c;
-                }
-                result += escaped;
-            } else {
-                result += element_desc;
+                out += ARRAY_SEPARATOR;
             }
+            elements[i]._write_desc(out, ARRAY_ESCAPED_CHARS);
         }
-
-        result += ARRAY_SUFFIX;
-        return result;
+        out += ARRAY_SUFFIX;
+        break;
     }
 
     case DICTIONARY: {
-        const auto &dict = std::get<std::map<variant, variant>>(_data);
-        text_t result{DICTIONARY_PREFIX};
-
-        size_t count = 0;
+        const auto &dict = _get_payload<variant_dictionary>();
+        out += DICTIONARY_PREFIX;
+        bool first = true;
         for (const auto &[key, value] : dict) {
-            if (count > 0) {
-                result += DICTIONARY_SEPARATOR;
+            if (!first) {
+                out += DICTIONARY_SEPARATOR;
             }
-
-            auto key_desc = key.to_desc();
-            auto value_desc = value.to_desc();
-
-            // Escape special characters if needed
-            auto escape_if_needed = [](const text_t &desc) -> text_t {
-                if (desc.size() >= 1 && (desc[0] == TEXT_PREFIX || desc[0] == ERROR_PREFIX)) {
-                    text_t escaped;
-                    escaped.reserve(desc.size());
-                    for (char c : desc) {
-                        if (c == ESCAPE_CHAR || c == DICTIONARY_SEPARATOR || c == DICTIONARY_KEY_VALUE_SEPARATOR || c == DICTIONARY_PREFIX ||
-                            c == DICTIONARY_SUFFIX || c == ARRAY_PREFIX || c == ARRAY_SUFFIX) {
-                            escaped += ESCAPE_CHAR;
-                        }
-                        escaped += c;
-                    }
-                    return escaped;
-                }
-                return desc;
-            };
-
-            result += escape_if_needed(key_desc);
-            result += DICTIONARY_KEY_VALUE_SEPARATOR;
-            result += escape_if_needed(value_desc);
-
-            count++;
+            first = false;
+            key._write_desc(out, DICTIONARY_ESCAPED_CHARS);
+            out += DICTIONARY_KEY_VALUE_SEPARATOR;
+            value._write_desc(out, DICTIONARY_ESCAPED_CHARS);
         }
-
-        result += DICTIONARY_SUFFIX;
-        return result;
-    }
-
-    case HASH: {
-        auto hash = std::get<hash_t>(_data);
-        return std::format("{}{:016X}", HASH_PREFIX, hash);
-    }
-
-    default:
-        return text_t{VOID_PREFIX}; // Fallback to VOID
-    }
-}
-
-variant variant::from_flatbuffers(const fb::Variant &v) {
-    variant res;
-    switch (v.data_type()) {
-    case fb::VariantData_error_value:
-        res._type = ERROR;
-        res._data = v.data_as_error_value()->c_str();
-        break;
-    case fb::VariantData_NONE:
-        res._type = VOID;
-        break;
-    case fb::VariantData_integer_value:
-        res._type = INTEGER;
-        res._data = v.data_as_integer_value()->value();
-        break;
-    case fb::VariantData_number_value:
-        res._type = NUMBER;
-        res._data = v.data_as_number_value()->value();
-        break;
-    case fb::VariantData_boolean_value:
-        res._type = BOOLEAN;
-        res._data = v.data_as_boolean_value()->value();
-        break;
-    case fb::VariantData_text_value:
-        res._type = TEXT;
-        res._data = v.data_as_text_value()->c_str();
-        break;
-    case fb::VariantData_vector2_value: {
-        const auto *vec = v.data_as_vector2_value();
-        res._type = VECTOR2;
-        res._data = vector2(vec->x(), vec->y());
-        break;
-    }
-    case fb::VariantData_vector3_value: {
-        const auto *vec = v.data_as_vector3_value();
-        res._type = VECTOR3;
-        res._data = vector3(vec->x(), vec->y(), vec->z());
-        break;
-    }
-    case fb::VariantData_vector4_value: {
-        const auto *vec = v.data_as_vector4_value();
-        res._type = VECTOR4;
-        res._data = vector4(vec->x(), vec->y(), vec->z(), vec->w());
-        break;
-    }
-    case fb::VariantData_bytes_value: {
-        const auto *b = v.data_as_bytes_value()->value();
-        res._type = BYTES;
-        res._data = bytes_t(b->begin(), b->end());
+        out += DICTIONARY_SUFFIX;
         break;
     }
-    case fb::VariantData_array_value: {
-        const auto *arr = v.data_as_array_value()->value();
-        res._type = ARRAY;
-        std::vector<variant> vec;
-        vec.reserve(arr->size());
 
-        for (const auto *item : *arr) {
-            vec.push_back(from_flatbuffers(*item));
+    case HASH: {
+        constexpr size_t HASH_DIGITS = 16;
+        out += HASH_PREFIX;
+        for (size_t i = HASH_DIGITS; i > 0; i--) {
+            out += HEX_DIGITS[(_data.h >> ((i - 1) * 4)) & 0xFU];
         }
-        res._data = vec;
-
         break;
     }
-    case fb::VariantData_dictionary_value: {
-        const auto *dict_data = v.data_as_dictionary_value()->pairs();
-        res._type = DICTIONARY;
-        std::map<variant, variant> dict;
 
-        for (const auto *pair : *dict_data) {
-            variant key = from_flatbuffers(*pair->key());
-            variant value = from_flatbuffers(*pair->value());
-            dict[key] = value;
-        }
-        res._data = dict;
-        break;
-    }
-    case fb::VariantData_hash_value:
-        res._type = HASH;
-        res._data = v.data_as_hash_value()->value();
+    default:
+        out += VOID_PREFIX; // Fallback to VOID
         break;
     }
-
-    return res;
 }
 
+variant variant::from_flatbuffers(const fb::Variant &v) { return variant_view(&v).to_variant(); }
+
 flatbuffers::Offset<fb::Variant> variant::to_flatbuffers(flatbuffers::FlatBufferBuilder &builder) const {
     fb::VariantData native_type{fb::VariantData_NONE};
     flatbuffers::Offset<void> data_offset{0};
@@ -964,37 +1207,37 @@ flatbuffers::Offset<fb::Variant> variant::to_flatbuffers(flatbuffers::FlatBuffer
     case VOID:
         break;
     case INTEGER:
-        native_type = fb::VariantData_integer_value;
-        data_offset = fb::CreateInt32Value(builder, static_cast<integer_t>(*this)).o;
+        native_type = fb::VariantData_integer_struct;
+        data_offset = builder.CreateStruct(fb::Int32Struct(_data.i)).o;
         break;
     case NUMBER:
-        native_type = fb::VariantData_number_value;
-        data_offset = fb::CreateFloatValue(builder, static_cast<number_t>(*this)).o;
+        native_type = fb::VariantData_number_struct;
+        data_offset = builder.CreateStruct(fb::FloatStruct(_data.n)).o;
         break;
     case BOOLEAN:
-        native_type = fb::VariantData_boolean_value;
-        data_offset = fb::CreateBoolValue(builder, static_cast<boolean_t>(*this)).o;
+        native_type = fb::VariantData_boolean_struct;
+        data_offset = builder.CreateStruct(fb::BoolStruct(_data.b)).o;
         break;
     case TEXT:
         native_type = fb::VariantData_text_value;
         data_offset = builder.CreateString(get_text().c_str()).o;
         break;
     case VECTOR2: {
-        const auto &vec = get_vector2();
-        native_type = fb::VariantData_vector2_value;
-        data_offset = fb::CreateVector2(builder, vec.get_x(), vec.get_y()).o;
+        const auto &vec = _data.v2;
+        native_type = fb::VariantData_vector2_struct;
+        data_offset = builder.CreateStruct(fb::Vector2Struct(vec.get_x(), vec.get_y())).o;
         break;
     }
     case VECTOR3: {
-        const auto &vec = get_vector3();
-        native_type = fb::VariantData_vector3_value;
-        data_offset = fb::CreateVector3(builder, vec.get_x(), vec.get_y(), vec.get_z()).o;
+        const auto &vec = _data.v3;
+        native_type = fb::VariantData_vector3_struct;
+        data_offset = builder.CreateStruct(fb::Vector3Struct(vec.get_x(), vec.get_y(), vec.get_z())).o;
         break;
     }
     case VECTOR4: {
-        const auto &vec = get_vector4();
-        native_type = fb::VariantData_vector4_value;
-        data_offset = fb::CreateVector4(builder, vec.get_x(), vec.get_y(), vec.get_z(), vec.get_w()).o;
+        const auto &vec = _data.v4;
+        native_type = fb::VariantData_vector4_struct;
+        data_offset = builder.CreateStruct(fb::Vector4Struct(vec.get_x(), vec.get_y(), vec.get_z(), vec.get_w())).o;
         break;
     }
     case BYTES: {
@@ -1032,12 +1275,351 @@ flatbuffers::Offset<fb::Variant> variant::to_flatbuffers(flatbuffers::FlatBuffer
         break;
     }
     case HASH:
-        native_type = fb::VariantData_hash_value;
-        data_offset = fb::CreateUInt64Value(builder, static_cast<uint64_t>(*this)).o;
+        native_type = fb::VariantData_hash_struct;
+        data_offset = builder.CreateStruct(fb::UInt64Struct(_data.h)).o;
         break;
     }
 
     return fb::CreateVariant(builder, native_type, data_offset);
 }
 
+bytes_t variant::to_binary() const {
+    bytes_t result;
+    to_binary(result);
+    return result;
+}
+
+void variant::to_binary(bytes_t &out) const {
+    using namespace serialization_helper;
+
+    out.push_back(static_cast<uint8_t>(_type));
+    switch (_type) {
+    case VOID:
+        break;
+    case INTEGER:
+        write_le32(out, static_cast<uint32_t>(_data.i));
+        break;
+    case NUMBER:
+        write_le_float(out, _data.n);
+        break;
+    case BOOLEAN:
+        out.push_back(_data.b ? 1U : 0U);
+        break;
+    case TEXT:
+    case ERROR: {
+        const auto &text = _get_payload<text_t>();
+        write_le32(out, static_cast<uint32_t>(text.size()));
+        out.insert(out.end(), text.begin(), text.end());
+        break;
+    }
+    case VECTOR2:
+        for (const auto d : _data.v2.dim) {
+            write_le_float(out, d);
+        }
+        break;
+    case VECTOR3:
+        for (const auto d : _data.v3.dim) {
+            write_le_float(out, d);
+        }
+        break;
+    case VECTOR4:
+        for (const auto d : _data.v4.dim) {
+            write_le_float(out, d);
+        }
+        break;
+    case BYTES: {
+        const auto &bytes = _get_payload<bytes_t>();
+        write_le32(out, static_cast<uint32_t>(bytes.size()));
+        out.insert(out.end(), bytes.begin(), bytes.end());
+        break;
+    }
+    case ARRAY: {
+        const auto &arr = _get_payload<std::vector<variant>>();
+        write_le32(out, static_cast<uint32_t>(arr.size()));
+        for (const auto &element : arr) {
+            element.to_binary(out);
+        }
+        break;
+    }
+    case DICTIONARY: {
+        const auto &dict = _get_payload<variant_dictionary>();
+        write_le32(out, static_cast<uint32_t>(dict.size()));
+        for (const auto &[key, value] : dict) {
+            key.to_binary(out);
+            value.to_binary(out);
+        }
+        break;
+    }
+    case HASH:
+        // The one scalar over 5 bytes. Hashes are xxh3 output, spread over all 64 bits, so a varint would grow
+        // them to 10 bytes instead of saving any.
+        write_le64(out, _data.h);
+        break;
+    }
+}
+
+namespace {
+// Decodes the compact binary form; any truncation or unknown tag fails the whole value.
+class binary_reader {
+public:
+    binary_reader(const bytes_t &data, size_t offset) : _data(data), _offset(offset) {}
+
+    [[nodiscard]] bool failed() const { return _failed; }
+    [[nodiscard]] size_t get_offset() const { return _offset; }
+
+    variant read_value() {
+        using namespace serialization_helper;
+
+        if (!_require(1)) {
+            return {};
+        }
+        const auto type = static_cast<variant::types>(static_cast<char>(_data[_offset++]));
+        switch (type) {
+        case variant::VOID:
+            return {};
+        case variant::INTEGER:
+            return _require(4) ? variant(static_cast<integer_t>(read_le32(_data, _offset))) : variant();
+        case variant::NUMBER:
+            return _require(4) ? variant(read_le_float(_data, _offset)) : variant();
+        case variant::BOOLEAN:
+            return _require(1) ? variant(_data[_offset++] != 0U) : variant();
+        case variant::TEXT:
+        case variant::ERROR: {
+            const auto length = _read_length(1);
+            if (_failed) {
+                return {};
+            }
+            text_t text(reinterpret_cast<const char *>(_data.data() + _offset), length);
+            _offset += length;
+            return {std::move(text), type == variant::ERROR};
+        }
+        case variant::VECTOR2: {
+            auto dim = _read_components<2>();
+            return {vector2(dim[0], dim[1])};
+        }
+        case variant::VECTOR3: {
+            auto dim = _read_components<3>();
+            return {vector3(dim[0], dim[1], dim[2])};
+        }
+        case variant::VECTOR4: {
+            auto dim = _read_components<4>();
+            return {vector4(dim[0], dim[1], dim[2], dim[3])};
+        }
+        case variant::BYTES: {
+            const auto length = _read_length(1);
+            if (_failed) {
+                return {};
+            }
+            const auto begin = _data.begin() + static_cast<std::ptrdiff_t>(_offset);
+            _offset += length;
+            return {bytes_t(begin, begin + static_cast<std::ptrdiff_t>(length))};
+        }
+        case variant::ARRAY: {
+            // every element takes at least its tag byte, which bounds the count before reserving
+            const auto count = _read_length(1);
+            if (!_enter()) {
+                return {};
+            }
+            std::vector<variant> elements;
+            elements.reserve(count);
+            for (size_t i = 0; i < count && !_failed; i++) {
+                elements.push_back(read_value());
+            }
+            _depth--;
+            return _failed ? variant() : variant(std::move(elements));
+        }
+        case variant::DICTIONARY: {
+            const auto count = _read_length(2);
+            if (!_enter()) {
+                return {};
+            }
+            variant_dictionary::container_type pairs;
+            pairs.reserve(count);
+            for (size_t i = 0; i < count && !_failed; i++) {
+                auto key = read_value();
+                pairs.emplace_back(std::move(key), read_value());
+            }
+            _depth--;
+            return _failed ? variant() : variant(variant_dictionary(std::move(pairs)));
+        }
+        case variant::HASH:
+            return _require(8) ? variant(static_cast<hash_t>(read_le64(_data, _offset))) : variant();
+        default:
+            _failed = true;
+            return {};
+        }
+    }
+
+private:
+    const bytes_t &_data;
+    size_t _offset;
+    size_t _depth{0};
+    bool _failed{false};
+
+    // Bounds the recursion so hostile input cannot exhaust the stack
+    bool _enter() {
+        if (_failed || _depth >= variant::MAX_BINARY_DEPTH) {
+            _failed = true;
+            return false;
+        }
+        _depth++;
+        return true;
+    }
+
+    bool _require(size_t n) {
+        if (_failed || _data.size() - _offset < n) {
+            _failed = true;
+        }
+        return !_failed;
+    }
+
+    // Reads a u32 length prefix for a payload of at least min_unit_size bytes per unit
+    size_t _read_length(size_t min_unit_size) {
+        if (!_require(4)) {
+            return 0;
+        }
+        const auto length = static_cast<size_t>(serialization_helper::read_le32(_data, _offset));
+        if (length > (_data.size() - _offset) / min_unit_size) {
+            _failed = true;
+            return 0;
+        }
+        return length;
+    }
+
+    template <size_t N> std::array<number_t, N> _read_components() {
+        std::array<number_t, N> dim{};
+        if (_require(N * 4)) {
+            for (auto &d : dim) {
+                d = serialization_helper::read_le_float(_data, _offset);
+            }
+        }
+        return dim;
+    }
+};
+} // namespace
+
+variant variant::from_binary(const bytes_t &data) {
+    size_t offset = 0;
+    return from_binary(data, offset);
+}
+
+variant variant::from_binary(const bytes_t &data, size_t &offset) {
+    if (offset > data.size()) {
+        return {};
+    }
+    binary_reader reader(data, offset);
+    auto result = reader.read_value();
+    if (reader.failed()) {
+        return {};
+    }
+    offset = reader.get_offset();
+    return result;
+}
+
+variant_dictionary::variant_dictionary(std::initializer_list<value_type> pairs) : variant_dictionary(container_type(pairs)) {}
+
+variant_dictionary::variant_dictionary(const std::map<variant, variant> &m) : _entries(m.begin(), m.end()) {}
+
+variant_dictionary::variant_dictionary(container_type &&pairs) : _entries(std::move(pairs)) {
+    auto key_less = [](const value_type &a, const value_type &b) { return a.first < b.first; };
+    if (!std::is_sorted(_entries.begin(), _entries.end(), key_less)) {
+        std::stable_sort(_entries.begin(), _entries.end(), key_less);
+    }
+
+    // collapse runs of equal keys, keeping the last pair of each run
+    auto out = _entries.begin();
+    for (auto it = _entries.begin(); it != _entries.end();) {
+        auto last = it;
+        while (std::next(last) != _entries.end() && !(it->first < std::next(last)->first)) {
+            ++last;
+        }
+        if (out != last) {
+            *out = std::move(*last);
+        }
+        ++out;
+        it = std::next(last);
+    }
+    _entries.erase(out, _entries.end());
+}
+
+bool variant_dictionary::operator==(const variant_dictionary &other) const { return _entries == other._entries; }
+
+bool variant_dictionary::operator!=(const variant_dictionary &other) const { return !(*this == other); }
+
+bool variant_dictionary::operator<(const variant_dictionary &other) const {
+    return std::lexicographical_compare(_entries.begin(), _entries.end(), other._entries.begin(), other._entries.end());
+}
+
+variant &variant_dictionary::operator[](const variant &key) { return operator[](variant(key)); }
+
+variant &variant_dictionary::operator[](variant &&key) {
+    // keys usually arrive in order (descriptors, flatbuffers, other dictionaries), so appending is the fast path
+    if (_entries.empty() || _entries.back().first < key) {
+        return _entries.emplace_back(std::move(key), variant()).second;
+    }
+
+    auto it = _lower_bound(key);
+    if (it != _entries.end() && !(key < it->first)) {
+        return it->second;
+    }
+    return _entries.emplace(it, std::move(key), variant())->second;
+}
+
+size_t variant_dictionary::size() const { return _entries.size(); }
+
+bool variant_dictionary::empty() const { return _entries.empty(); }
+
+variant_dictionary::const_iterator variant_dictionary::begin() const { return _entries.begin(); }
+
+variant_dictionary::const_iterator variant_dictionary::end() const { return _entries.end(); }
+
+variant_dictionary::const_iterator variant_dictionary::find(const variant &key) const {
+    auto it = _lower_bound(key);
+    if (it != _entries.end() && !(key < it->first)) {
+        return it;
+    }
+    return _entries.end();
+}
+
+bool variant_dictionary::contains(const variant &key) const { return find(key) != _entries.end(); }
+
+const variant &variant_dictionary::at(const variant &key) const {
+    auto it = find(key);
+    if (it == _entries.end()) {
+        throw std::out_of_range("variant_dictionary::at");
+    }
+    return it->second;
+}
+
+variant &variant_dictionary::at(const variant &key) {
+    auto it = _lower_bound(key);
+    if (it == _entries.end() || key < it->first) {
+        throw std::out_of_range("variant_dictionary::at");
+    }
+    return it->second;
+}
+
+void variant_dictionary::insert_or_assign(variant key, variant value) { operator[](std::move(key)) = std::move(value); }
+
+bool variant_dictionary::erase(const variant &key) {
+    auto it = _lower_bound(key);
+    if (it == _entries.end() || key < it->first) {
+        return false;
+    }
+    _entries.erase(it);
+    return true;
+}
+
+void variant_dictionary::reserve(size_t capacity) { _entries.reserve(capacity); }
+
+void variant_dictionary::clear() { _entries.clear(); }
+
+variant_dictionary::container_type::iterator variant_dictionary::_lower_bound(const variant &key) {
+    return std::lower_bound(_entries.begin(), _entries.end(), key, [](const value_type &entry, const variant &k) { return entry.first < k; });
+}
+
+variant_dictionary::const_iterator variant_dictionary::_lower_bound(const variant &key) const {
+    return std::lower_bound(_entries.begin(), _entries.end(), key, [](const value_type &entry, const variant &k) { return entry.first < k; });
+}
+
 } // namespace camellia
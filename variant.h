@@ -5,8 +5,11 @@
 #include "flatbuffers/flatbuffer_builder.h"
 #include "variant_generated.h"
 #include <array>
+#include <atomic>
 #include <format>
+#include <initializer_list>
 #include <map>
+#include <string_view>
 #include <variant>
 #include <vector>
 
@@ -16,7 +19,15 @@ namespace camellia {
     bool operator==(const vector##X &other) const;                                                                                                             \
     bool operator!=(const vector##X &other) const;                                                                                                             \
                                                                                                                                                                \
-    [[nodiscard]] bool approx_equals(const vector##X &other) const
+    [[nodiscard]] bool approx_equals(const vector##X &other) const;                                                                                            \
+                                                                                                                                                               \
+    vector##X operator+(const vector##X &other) const;                                                                                                         \
+    vector##X operator-(const vector##X &other) const;                                                                                                         \
+    vector##X operator*(number_t factor) const;                                                                                                                \
+    [[nodiscard]] static vector##X lerp(const vector##X &from, const vector##X &to, number_t t)
+
+class variant_dictionary;
+class string_interner;
 
 struct vector2 {
     DEF_VECTOR_COMMON_OPS(2);
@@ -88,7 +99,11 @@ public:
     bool operator<(const variant &other) const;
     variant &operator=(const variant &v);
     variant();
-    ~variant() = default;
+    ~variant() {
+        if (_is_heap_backed(_type)) {
+            _release();
+        }
+    }
     explicit operator integer_t() const;
     explicit operator number_t() const;
     explicit operator boolean_t() const;
@@ -99,17 +114,53 @@ public:
     [[nodiscard]] const vector4 &get_vector4() const;
     [[nodiscard]] const bytes_t &get_bytes() const;
     [[nodiscard]] const std::vector<variant> &get_array() const;
-    [[nodiscard]] const std::map<variant, variant> &get_dictionary() const;
+    [[nodiscard]] const variant_dictionary &get_dictionary() const;
     [[nodiscard]] bool approx_equals(const variant &other) const;
 
+    // Arithmetic on INTEGER/NUMBER and same-sized vectors; other kinds throw std::bad_variant_access.
+    // Two INTEGERs stay INTEGER under add/subtract, any other numeric mix yields NUMBER.
+    [[nodiscard]] variant add(const variant &other) const;
+    [[nodiscard]] variant subtract(const variant &other) const;
+    [[nodiscard]] variant scale(number_t factor) const;
+    // from + (to - from) * t, without clamping t
+    [[nodiscard]] static variant lerp(const variant &from, const variant &to, number_t t);
+
+    // TEXT/ERROR only: algorithm_helper::calc_hash of the text, precomputed for interned values
+    [[nodiscard]] hash_t get_text_hash() const;
+    [[nodiscard]] bool is_interned() const;
+
+    // XXH3 over the content, consistent with operator==; backs std::hash<variant>.
+    // Shared BYTES/ARRAY/DICTIONARY payloads of at least HASH_CACHE_MIN_SIZE bytes/elements cache the result.
+    [[nodiscard]] hash_t get_hash() const;
+    constexpr static size_t HASH_CACHE_MIN_SIZE = 64;
+
+    // Mutable access to heap-backed payloads. Copies share their payload until one of them is edited.
+    text_t &edit_text();
+    bytes_t &edit_bytes();
+    std::vector<variant> &edit_array();
+    variant_dictionary &edit_dictionary();
+
     // Descriptor conversion functions
-    static variant from_desc(const text_t &descriptor);
+    static variant from_desc(std::string_view descriptor);
     [[nodiscard]] text_t to_desc() const;
+    // Appends the descriptor to out, reusing its capacity
+    void to_desc(text_t &out) const;
 
     // FlatBuffers conversion functions
     static variant from_flatbuffers(const fb::Variant &v);
     flatbuffers::Offset<fb::Variant> to_flatbuffers(flatbuffers::FlatBufferBuilder &builder) const;
 
+    // Compact binary conversion functions: a one-byte type tag followed by the little-endian payload.
+    // TEXT/ERROR/BYTES carry a u32 length, ARRAY/DICTIONARY a u32 element count; numbers round-trip bit-exact.
+    // Scalars take at most 5 bytes, except HASH, which is always 9 (see to_binary).
+    // Truncated or malformed input, or containers nested deeper than MAX_BINARY_DEPTH, decode as VOID, leaving offset untouched.
+    static variant from_binary(const bytes_t &data);
+    static variant from_binary(const bytes_t &data, size_t &offset);
+    [[nodiscard]] bytes_t to_binary() const;
+    // Appends the encoding to out, reusing its capacity
+    void to_binary(bytes_t &out) const;
+    constexpr static size_t MAX_BINARY_DEPTH = 64;
+
     constexpr static char VOID_PREFIX = 'V';
     constexpr static char INTEGER_PREFIX = 'I';
     constexpr static char NUMBER_PREFIX = 'N';
@@ -140,25 +191,14 @@ public:
 
     constexpr static char ESCAPE_CHAR = '\\';
 
-    variant(const variant &v) = default;
+    variant(const variant &v) : _data(v._data), _type(v._type) {
+        if (_is_heap_backed(_type)) {
+            _data.p_payload->ref_count.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
     variant &operator=(variant &&v) noexcept;
     variant(variant &&v) noexcept;
 
-    // Using std::variant instead of union
-    using variant_storage = std::variant<std::monostate,             // VOID
-                                         integer_t,                  // INTEGER
-                                         number_t,                   // NUMBER
-                                         boolean_t,                  // BOOLEAN
-                                         text_t,                     // TEXT or ERROR
-                                         vector2,                    // VECTOR2
-                                         vector3,                    // VECTOR3
-                                         vector4,                    // VECTOR4
-                                         bytes_t,                    // BYTES
-                                         std::vector<variant>,       // ARRAY
-                                         std::map<variant, variant>, // DICTIONARY
-                                         hash_t                      // ATTRIBUTE
-                                         >;
-
     explicit(false) variant(integer_t i);
     explicit(false) variant(number_t n);
     explicit(false) variant(boolean_t b);
@@ -174,13 +214,95 @@ public:
     explicit(false) variant(std::vector<variant> &&a);
     explicit(false) variant(const std::map<variant, variant> &d);
     explicit(false) variant(std::map<variant, variant> &&d);
+    explicit(false) variant(const variant_dictionary &d);
+    explicit(false) variant(variant_dictionary &&d);
     explicit(false) variant(hash_t h);
 
 private:
+    friend class string_interner;
+
+    // Heap-backed kinds point to a reference-counted block that is never mutated while shared.
+    struct payload_header {
+        std::atomic<uint32_t> ref_count{1};
+
+        // Set on text payloads owned by a string_interner, which also fills in h_text
+        const string_interner *p_interner{nullptr};
+        hash_t h_text{0ULL};
+
+        // Cached get_hash() of a shared payload, 0 when not computed; cleared whenever the payload is edited
+        std::atomic<hash_t> h_content{0ULL};
+    };
+
+    template <typename T> struct payload : payload_header {
+        template <typename... Args> explicit payload(Args &&...args) : value(std::forward<Args>(args)...) {}
+
+        T value;
+    };
+
+    // Single-tag storage: scalars and vectors live inline, heap-backed kinds keep a pointer to a shared payload.
+    union storage {
+        integer_t i;
+        number_t n;
+        boolean_t b;
+        hash_t h;
+        vector2 v2;
+        vector3 v3;
+        vector4 v4;
+        payload_header *p_payload;
+
+        storage() : h(0ULL) {}
+    };
+
+    storage _data;
     types _type;
-    variant_storage _data;
 
     explicit variant(types t);
+    void _release() noexcept;
+    void _write_desc(text_t &out, std::string_view escaped_chars) const;
+    template <typename T> [[nodiscard]] const T &_get_payload() const;
+    template <typename T> T &_edit_payload();
+
+    static constexpr bool _is_heap_backed(types t) { return t == TEXT || t == ERROR || (t >= BYTES && t <= DICTIONARY); }
+};
+
+// Dictionary payload of a variant: key-value pairs kept in a contiguous vector sorted by key.
+class variant_dictionary {
+public:
+    using value_type = std::pair<variant, variant>;
+    using container_type = std::vector<value_type>;
+    using const_iterator = container_type::const_iterator;
+
+    variant_dictionary() = default;
+    variant_dictionary(std::initializer_list<value_type> pairs);
+    explicit(false) variant_dictionary(const std::map<variant, variant> &m);
+
+    // Takes unsorted pairs; on duplicate keys the last pair wins.
+    explicit variant_dictionary(container_type &&pairs);
+
+    bool operator==(const variant_dictionary &other) const;
+    bool operator!=(const variant_dictionary &other) const;
+    bool operator<(const variant_dictionary &other) const;
+    variant &operator[](const variant &key);
+    variant &operator[](variant &&key);
+
+    [[nodiscard]] size_t size() const;
+    [[nodiscard]] bool empty() const;
+    [[nodiscard]] const_iterator begin() const;
+    [[nodiscard]] const_iterator end() const;
+    [[nodiscard]] const_iterator find(const variant &key) const;
+    [[nodiscard]] bool contains(const variant &key) const;
+    [[nodiscard]] const variant &at(const variant &key) const;
+    variant &at(const variant &key);
+    void insert_or_assign(variant key, variant value);
+    bool erase(const variant &key);
+    void reserve(size_t capacity);
+    void clear();
+
+private:
+    container_type _entries;
+
+    [[nodiscard]] container_type::iterator _lower_bound(const variant &key);
+    [[nodiscard]] const_iterator _lower_bound(const variant &key) const;
 };
 
 } // namespace camellia
@@ -241,89 +363,7 @@ private:
 };
 
 template <> struct std::hash<camellia::variant> {
-    std::size_t operator()(const camellia::variant &v) const noexcept {
-        std::size_t seed = std::hash<int>{}(static_cast<int>(v.get_value_type()));
-
-        // Helper function to combine hashes using boost::hash_combine algorithm
-        auto hash_combine = [](std::size_t &seed, std::size_t hash) {
-            // Golden ratio constant for hash mixing
-            constexpr std::size_t kGoldenRatio = 0x9e3779b9;
-            constexpr std::size_t kLeftShift = 6;
-            constexpr std::size_t kRightShift = 2;
-            seed ^= hash + kGoldenRatio + (seed << kLeftShift) + (seed >> kRightShift);
-        };
-
-        switch (v.get_value_type()) {
-        case camellia::variant::VOID:
-            // No additional data to hash
-            break;
-        case camellia::variant::INTEGER:
-            hash_combine(seed, std::hash<camellia::integer_t>{}(static_cast<camellia::integer_t>(v)));
-            break;
-        case camellia::variant::NUMBER: {
-            auto num = static_cast<camellia::number_t>(v);
-            hash_combine(seed, std::hash<camellia::number_t>{}(num));
-            break;
-        }
-        case camellia::variant::BOOLEAN:
-            hash_combine(seed, std::hash<camellia::boolean_t>{}(static_cast<camellia::boolean_t>(v)));
-            break;
-        case camellia::variant::TEXT:
-        case camellia::variant::ERROR:
-            hash_combine(seed, std::hash<camellia::text_t>{}(v.get_text()));
-            break;
-        case camellia::variant::VECTOR2: {
-            const auto &vec = v.get_vector2();
-            hash_combine(seed, std::hash<camellia::number_t>{}(vec.get_x()));
-            hash_combine(seed, std::hash<camellia::number_t>{}(vec.get_y()));
-            break;
-        }
-        case camellia::variant::VECTOR3: {
-            const auto &vec = v.get_vector3();
-            hash_combine(seed, std::hash<camellia::number_t>{}(vec.get_x()));
-            hash_combine(seed, std::hash<camellia::number_t>{}(vec.get_y()));
-            hash_combine(seed, std::hash<camellia::number_t>{}(vec.get_z()));
-            break;
-        }
-        case camellia::variant::VECTOR4: {
-            const auto &vec = v.get_vector4();
-            hash_combine(seed, std::hash<camellia::number_t>{}(vec.get_x()));
-            hash_combine(seed, std::hash<camellia::number_t>{}(vec.get_y()));
-            hash_combine(seed, std::hash<camellia::number_t>{}(vec.get_z()));
-            hash_combine(seed, std::hash<camellia::number_t>{}(vec.get_w()));
-            break;
-        }
-        case camellia::variant::BYTES: {
-            const auto &bytes = v.get_bytes();
-            for (const auto byte : bytes) {
-                hash_combine(seed, std::hash<std::uint8_t>{}(byte));
-            }
-            break;
-        }
-        case camellia::variant::ARRAY: {
-            const auto &arr = v.get_array();
-            for (const auto &element : arr) {
-                hash_combine(seed, std::hash<camellia::variant>{}(element));
-            }
-            break;
-        }
-        case camellia::variant::DICTIONARY: {
-            const auto &dict = v.get_dictionary();
-            for (const auto &[key, value] : dict) {
-                hash_combine(seed, std::hash<camellia::variant>{}(key));
-                hash_combine(seed, std::hash<camellia::variant>{}(value));
-            }
-            break;
-        }
-        case camellia::variant::HASH:
-            hash_combine(seed, std::hash<camellia::hash_t>{}(static_cast<camellia::hash_t>(v)));
-            break;
-        default:
-            break;
-        }
-
-        return seed;
-    }
+    std::size_t operator()(const camellia::variant &v) const noexcept { return static_cast<std::size_t>(v.get_hash()); }
 };
 
 #endif // CAMELLIA_VARIANT_H
\ No newline at end of file
@@ -0,0 +1,399 @@
+#include "variant_view.h"
+#include <algorithm>
+#include <array>
+#include <compare>
+#include <type_traits>
+#include <variant>
+
+namespace camellia {
+
+variant::types variant_view::get_value_type() const {
+    if (_p_variant == nullptr) {
+        return variant::VOID;
+    }
+
+    switch (_p_variant->data_type()) {
+    case fb::VariantData_error_value:
+        return variant::ERROR;
+    case fb::VariantData_integer_struct:
+    case fb::VariantData_integer_value:
+        return variant::INTEGER;
+    case fb::VariantData_number_struct:
+    case fb::VariantData_number_value:
+        return variant::NUMBER;
+    case fb::VariantData_boolean_struct:
+    case fb::VariantData_boolean_value:
+        return variant::BOOLEAN;
+    case fb::VariantData_text_value:
+        return variant::TEXT;
+    case fb::VariantData_vector2_struct:
+    case fb::VariantData_vector2_value:
+        return variant::VECTOR2;
+    case fb::VariantData_vector3_struct:
+    case fb::VariantData_vector3_value:
+        return variant::VECTOR3;
+    case fb::VariantData_vector4_struct:
+    case fb::VariantData_vector4_value:
+        return variant::VECTOR4;
+    case fb::VariantData_bytes_value:
+        return variant::BYTES;
+    case fb::VariantData_array_value:
+        return variant::ARRAY;
+    case fb::VariantData_dictionary_value:
+        return variant::DICTIONARY;
+    case fb::VariantData_hash_struct:
+    case fb::VariantData_hash_value:
+        return variant::HASH;
+    default:
+        return variant::VOID;
+    }
+}
+
+variant_view::operator integer_t() const {
+    if (get_value_type() == variant::INTEGER) {
+        if (const auto *p_value = _p_variant->data_as_integer_struct(); p_value != nullptr) {
+            return p_value->value();
+        }
+        // table layout written by older builds
+        if (const auto *p_value = _p_variant->data_as_integer_value(); p_value != nullptr) {
+            return p_value->value();
+        }
+    }
+    throw std::bad_variant_access();
+}
+
+variant_view::operator number_t() const {
+    if (get_value_type() == variant::NUMBER) {
+        if (const auto *p_value = _p_variant->data_as_number_struct(); p_value != nullptr) {
+            return p_value->value();
+        }
+        if (const auto *p_value = _p_variant->data_as_number_value(); p_value != nullptr) {
+            return p_value->value();
+        }
+    }
+    throw std::bad_variant_access();
+}
+
+variant_view::operator boolean_t() const {
+    if (get_value_type() == variant::BOOLEAN) {
+        if (const auto *p_value = _p_variant->data_as_boolean_struct(); p_value != nullptr) {
+            return p_value->value();
+        }
+        if (const auto *p_value = _p_variant->data_as_boolean_value(); p_value != nullptr) {
+            return p_value->value();
+        }
+    }
+    throw std::bad_variant_access();
+}
+
+variant_view::operator hash_t() const {
+    if (get_value_type() == variant::HASH) {
+        if (const auto *p_value = _p_variant->data_as_hash_struct(); p_value != nullptr) {
+            return p_value->value();
+        }
+        if (const auto *p_value = _p_variant->data_as_hash_value(); p_value != nullptr) {
+            return p_value->value();
+        }
+    }
+    throw std::bad_variant_access();
+}
+
+std::string_view variant_view::get_text() const {
+    const flatbuffers::String *p_text = nullptr;
+    switch (get_value_type()) {
+    case variant::TEXT:
+        p_text = _p_variant->data_as_text_value();
+        break;
+    case variant::ERROR:
+        p_text = _p_variant->data_as_error_value();
+        break;
+    default:
+        throw std::bad_variant_access();
+    }
+    return p_text != nullptr ? std::string_view(p_text->c_str(), p_text->size()) : std::string_view();
+}
+
+vector2 variant_view::get_vector2() const {
+    if (get_value_type() == variant::VECTOR2) {
+        if (const auto *p_vec = _p_variant->data_as_vector2_struct(); p_vec != nullptr) {
+            return {p_vec->x(), p_vec->y()};
+        }
+        if (const auto *p_vec = _p_variant->data_as_vector2_value(); p_vec != nullptr) {
+            return {p_vec->x(), p_vec->y()};
+        }
+    }
+    throw std::bad_variant_access();
+}
+
+vector3 variant_view::get_vector3() const {
+    if (get_value_type() == variant::VECTOR3) {
+        if (const auto *p_vec = _p_variant->data_as_vector3_struct(); p_vec != nullptr) {
+            return {p_vec->x(), p_vec->y(), p_vec->z()};
+        }
+        if (const auto *p_vec = _p_variant->data_as_vector3_value(); p_vec != nullptr) {
+            return {p_vec->x(), p_vec->y(), p_vec->z()};
+        }
+    }
+    throw std::bad_variant_access();
+}
+
+vector4 variant_view::get_vector4() const {
+    if (get_value_type() == variant::VECTOR4) {
+        if (const auto *p_vec = _p_variant->data_as_vector4_struct(); p_vec != nullptr) {
+            return {p_vec->x(), p_vec->y(), p_vec->z(), p_vec->w()};
+        }
+        if (const auto *p_vec = _p_variant->data_as_vector4_value(); p_vec != nullptr) {
+            return {p_vec->x(), p_vec->y(), p_vec->z(), p_vec->w()};
+        }
+    }
+    throw std::bad_variant_access();
+}
+
+std::span<const uint8_t> variant_view::get_bytes() const {
+    if (get_value_type() != variant::BYTES) {
+        throw std::bad_variant_access();
+    }
+    const auto *p_bytes = _p_variant->data_as_bytes_value();
+    if (p_bytes == nullptr || p_bytes->value() == nullptr) {
+        return {};
+    }
+    return {p_bytes->value()->data(), p_bytes->value()->size()};
+}
+
+variant_view::array_range variant_view::get_array() const {
+    if (get_value_type() != variant::ARRAY) {
+        throw std::bad_variant_access();
+    }
+    const auto *p_array = _p_variant->data_as_array_value();
+    return array_range(p_array != nullptr ? p_array->value() : nullptr);
+}
+
+variant_view::dictionary_range variant_view::get_dictionary() const {
+    if (get_value_type() != variant::DICTIONARY) {
+        throw std::bad_variant_access();
+    }
+    const auto *p_dict = _p_variant->data_as_dictionary_value();
+    return dictionary_range(p_dict != nullptr ? p_dict->pairs() : nullptr);
+}
+
+namespace {
+template <typename T> int three_way(const T &a, const T &b) { return a < b ? -1 : (b < a ? 1 : 0); }
+
+template <size_t N> int compare_components(const std::array<number_t, N> &a, const std::array<number_t, N> &b) {
+    for (size_t i = 0; i < N; i++) {
+        if (a[i] != b[i]) {
+            return three_way(a[i], b[i]);
+        }
+    }
+    return 0;
+}
+
+// Shared by both compare() overloads, other is either a variant or another view
+template <typename V> int compare_to(const variant_view &view, const V &other) {
+    const auto type = view.get_value_type();
+    if (type != other.get_value_type()) {
+        return three_way(type, other.get_value_type());
+    }
+
+    switch (type) {
+    case variant::VOID:
+        return 0;
+    case variant::BOOLEAN:
+        return three_way(static_cast<integer_t>(static_cast<boolean_t>(view)), static_cast<integer_t>(static_cast<boolean_t>(other)));
+    case variant::INTEGER:
+        return three_way(static_cast<integer_t>(view), static_cast<integer_t>(other));
+    case variant::NUMBER:
+        return three_way(static_cast<number_t>(view), static_cast<number_t>(other));
+    case variant::TEXT:
+    case variant::ERROR: {
+        const auto order = view.get_text().compare(other.get_text());
+        return order < 0 ? -1 : (order > 0 ? 1 : 0);
+    }
+    case variant::VECTOR2:
+        return compare_components(view.get_vector2().dim, other.get_vector2().dim);
+    case variant::VECTOR3:
+        return compare_components(view.get_vector3().dim, other.get_vector3().dim);
+    case variant::VECTOR4:
+        return compare_components(view.get_vector4().dim, other.get_vector4().dim);
+    case variant::BYTES: {
+        const auto bytes = view.get_bytes();
+        const auto &other_bytes = other.get_bytes();
+        const auto order = std::lexicographical_compare_three_way(bytes.begin(), bytes.end(), other_bytes.begin(), other_bytes.end());
+        return order < 0 ? -1 : (order > 0 ? 1 : 0);
+    }
+    case variant::HASH:
+        return three_way(static_cast<hash_t>(view), static_cast<hash_t>(other));
+    default: {
+        // Container keys are rare enough that materializing them is fine
+        const auto value = view.to_variant();
+        if constexpr (std::is_same_v<V, variant_view>) {
+            const auto other_value = other.to_variant();
+            return value < other_value ? -1 : (other_value < value ? 1 : 0);
+        } else {
+            return value < other ? -1 : (other < value ? 1 : 0);
+        }
+    }
+    }
+}
+} // namespace
+
+int variant_view::compare(const variant &other) const { return compare_to(*this, other); }
+
+int variant_view::compare(const variant_view &other) const { return compare_to(*this, other); }
+
+bool variant_view::dictionary_range::is_sorted() const {
+    for (flatbuffers::uoffset_t i = 1; i < size(); i++) {
+        if (variant_view(_p_pairs->Get(i - 1)->key()).compare(variant_view(_p_pairs->Get(i)->key())) >= 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+variant_view variant_view::dictionary_range::find(const variant &key) const {
+    flatbuffers::uoffset_t lo = 0;
+    auto hi = static_cast<flatbuffers::uoffset_t>(size());
+    while (lo < hi) {
+        const auto mid = lo + ((hi - lo) / 2);
+        const auto *p_pair = _p_pairs->Get(mid);
+        const auto order = variant_view(p_pair->key()).compare(key);
+        if (order == 0) {
+            return variant_view(p_pair->value());
+        }
+        if (order < 0) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+
+    // A miss is only trusted for sorted pairs, buffers not written by variant::to_flatbuffers may be in any order
+    if (!is_sorted()) {
+        for (flatbuffers::uoffset_t i = 0; i < size(); i++) {
+            const auto *p_pair = _p_pairs->Get(i);
+            if (variant_view(p_pair->key()).compare(key) == 0) {
+                return variant_view(p_pair->value());
+            }
+        }
+    }
+    return variant_view(nullptr);
+}
+
+
+bool variant_view::operator==(const variant &other) const {
+    const auto type = get_value_type();
+    if (type != other.get_value_type()) {
+        return false;
+    }
+
+    switch (type) {
+    case variant::VOID:
+        return true;
+    case variant::INTEGER:
+        return static_cast<integer_t>(*this) == static_cast<integer_t>(other);
+    case variant::NUMBER:
+        return static_cast<number_t>(*this) == static_cast<number_t>(other);
+    case variant::BOOLEAN:
+        return static_cast<boolean_t>(*this) == static_cast<boolean_t>(other);
+    case variant::TEXT:
+    case variant::ERROR:
+        return get_text() == other.get_text();
+    case variant::VECTOR2:
+        return get_vector2() == other.get_vector2();
+    case variant::VECTOR3:
+        return get_vector3() == other.get_vector3();
+    case variant::VECTOR4:
+        return get_vector4() == other.get_vector4();
+    case variant::BYTES: {
+        auto bytes = get_bytes();
+        const auto &other_bytes = other.get_bytes();
+        return std::equal(bytes.begin(), bytes.end(), other_bytes.begin(), other_bytes.end());
+    }
+    case variant::ARRAY: {
+        auto arr = get_array();
+        const auto &other_arr = other.get_array();
+        if (arr.size() != other_arr.size()) {
+            return false;
+        }
+        for (size_t i = 0; i < arr.size(); i++) {
+            if (!(arr[i] == other_arr[i])) {
+                return false;
+            }
+        }
+        return true;
+    }
+    case variant::DICTIONARY: {
+        auto dict = get_dictionary();
+        const auto &other_dict = other.get_dictionary();
+        if (dict.size() != other_dict.size()) {
+            return false;
+        }
+        if (!dict.is_sorted()) [[unlikely]] {
+            // Pairs in any order, the owning dictionary sorts them on construction
+            return to_variant() == other;
+        }
+        // Both sides are sorted by key, so equal dictionaries line up pair by pair
+        auto it = other_dict.begin();
+        for (auto [key, value] : dict) {
+            if (!(key == it->first) || !(value == it->second)) {
+                return false;
+            }
+            ++it;
+        }
+        return true;
+    }
+    case variant::HASH:
+        return static_cast<hash_t>(*this) == static_cast<hash_t>(other);
+    default:
+        return false;
+    }
+}
+
+variant variant_view::to_variant() const {
+    switch (get_value_type()) {
+    case variant::ERROR:
+        return {text_t(get_text()), true};
+    case variant::INTEGER:
+        return {static_cast<integer_t>(*this)};
+    case variant::NUMBER:
+        return {static_cast<number_t>(*this)};
+    case variant::BOOLEAN:
+        return {static_cast<boolean_t>(*this)};
+    case variant::TEXT:
+        return {text_t(get_text())};
+    case variant::VECTOR2:
+        return {get_vector2()};
+    case variant::VECTOR3:
+        return {get_vector3()};
+    case variant::VECTOR4:
+        return {get_vector4()};
+    case variant::BYTES: {
+        auto bytes = get_bytes();
+        return {bytes_t(bytes.begin(), bytes.end())};
+    }
+    case variant::ARRAY: {
+        auto arr = get_array();
+        std::vector<variant> vec;
+        vec.reserve(arr.size());
+        for (auto item : arr) {
+            vec.push_back(item.to_variant());
+        }
+        return {std::move(vec)};
+    }
+    case variant::DICTIONARY: {
+        auto dict = get_dictionary();
+        variant_dictionary::container_type pairs;
+        pairs.reserve(dict.size());
+        for (auto [key, value] : dict) {
+            pairs.emplace_back(key.to_variant(), value.to_variant());
+        }
+        return {variant_dictionary(std::move(pairs))};
+    }
+    case variant::HASH:
+        return {static_cast<hash_t>(*this)};
+    default:
+        return {};
+    }
+}
+
+} // namespace camellia
@@ -0,0 +1,143 @@
+#ifndef CAMELLIA_VARIANT_VIEW_H
+#define CAMELLIA_VARIANT_VIEW_H
+
+#include "camellia_typedef.h"
+#include "variant.h"
+#include "variant_generated.h"
+#include <cstddef>
+#include <iterator>
+#include <span>
+#include <string_view>
+#include <utility>
+
+namespace camellia {
+
+// Read-only view of a serialized fb::Variant. Accessors read straight from the buffer, nothing is materialized
+// unless to_variant() is called. The view is only valid as long as the underlying buffer is.
+// Fixed-size kinds are read from either the struct members of fb::VariantData or the older table members.
+class variant_view {
+public:
+    class array_range;
+    class dictionary_range;
+
+    explicit variant_view(const fb::Variant *p_variant) : _p_variant(p_variant) {}
+
+    [[nodiscard]] variant::types get_value_type() const;
+    explicit operator integer_t() const;
+    explicit operator number_t() const;
+    explicit operator boolean_t() const;
+    explicit operator hash_t() const;
+    [[nodiscard]] std::string_view get_text() const;
+    [[nodiscard]] vector2 get_vector2() const;
+    [[nodiscard]] vector3 get_vector3() const;
+    [[nodiscard]] vector4 get_vector4() const;
+    [[nodiscard]] std::span<const uint8_t> get_bytes() const;
+    [[nodiscard]] array_range get_array() const;
+    [[nodiscard]] dictionary_range get_dictionary() const;
+
+    // Compares against an owning variant without materializing this view
+    bool operator==(const variant &other) const;
+    // Negative, zero or positive as this view orders before, equal to or after other under variant::operator<
+    [[nodiscard]] int compare(const variant &other) const;
+    [[nodiscard]] int compare(const variant_view &other) const;
+
+    [[nodiscard]] variant to_variant() const;
+    [[nodiscard]] const fb::Variant *get_flatbuffers() const { return _p_variant; }
+
+    using fb_array_t = flatbuffers::Vector<flatbuffers::Offset<fb::Variant>>;
+    using fb_dictionary_t = flatbuffers::Vector<flatbuffers::Offset<fb::VariantKeyValuePair>>;
+
+    class array_range {
+    public:
+        class iterator {
+        public:
+            using iterator_category = std::forward_iterator_tag;
+            using value_type = variant_view;
+            using difference_type = std::ptrdiff_t;
+
+            iterator() = default;
+            iterator(const fb_array_t *p_array, flatbuffers::uoffset_t index) : _p_array(p_array), _index(index) {}
+
+            variant_view operator*() const { return variant_view(_p_array->Get(_index)); }
+            iterator &operator++() {
+                ++_index;
+                return *this;
+            }
+            iterator operator++(int) {
+                auto it = *this;
+                ++_index;
+                return it;
+            }
+            bool operator==(const iterator &other) const { return _index == other._index; }
+
+        private:
+            const fb_array_t *_p_array{nullptr};
+            flatbuffers::uoffset_t _index{0};
+        };
+
+        explicit array_range(const fb_array_t *p_array) : _p_array(p_array) {}
+
+        [[nodiscard]] size_t size() const { return _p_array != nullptr ? _p_array->size() : 0; }
+        [[nodiscard]] bool empty() const { return size() == 0; }
+        [[nodiscard]] iterator begin() const { return {_p_array, 0}; }
+        [[nodiscard]] iterator end() const { return {_p_array, static_cast<flatbuffers::uoffset_t>(size())}; }
+        variant_view operator[](size_t index) const { return variant_view(_p_array->Get(static_cast<flatbuffers::uoffset_t>(index))); }
+
+    private:
+        const fb_array_t *_p_array;
+    };
+
+    class dictionary_range {
+    public:
+        class iterator {
+        public:
+            using iterator_category = std::forward_iterator_tag;
+            using value_type = std::pair<variant_view, variant_view>;
+            using difference_type = std::ptrdiff_t;
+
+            iterator() = default;
+            iterator(const fb_dictionary_t *p_pairs, flatbuffers::uoffset_t index) : _p_pairs(p_pairs), _index(index) {}
+
+            value_type operator*() const {
+                const auto *p_pair = _p_pairs->Get(_index);
+                return {variant_view(p_pair->key()), variant_view(p_pair->value())};
+            }
+            iterator &operator++() {
+                ++_index;
+                return *this;
+            }
+            iterator operator++(int) {
+                auto it = *this;
+                ++_index;
+                return it;
+            }
+            bool operator==(const iterator &other) const { return _index == other._index; }
+
+        private:
+            const fb_dictionary_t *_p_pairs{nullptr};
+            flatbuffers::uoffset_t _index{0};
+        };
+
+        explicit dictionary_range(const fb_dictionary_t *p_pairs) : _p_pairs(p_pairs) {}
+
+        [[nodiscard]] size_t size() const { return _p_pairs != nullptr ? _p_pairs->size() : 0; }
+        [[nodiscard]] bool empty() const { return size() == 0; }
+        [[nodiscard]] iterator begin() const { return {_p_pairs, 0}; }
+        [[nodiscard]] iterator end() const { return {_p_pairs, static_cast<flatbuffers::uoffset_t>(size())}; }
+        // Value stored under key, or a VOID view if absent. variant::to_flatbuffers writes pairs sorted by key, so this is a
+        // binary search; a miss is checked with a linear scan if the pairs turn out not to be sorted.
+        [[nodiscard]] variant_view find(const variant &key) const;
+        // Whether keys strictly ascend in variant order
+        [[nodiscard]] bool is_sorted() const;
+
+    private:
+        const fb_dictionary_t *_p_pairs;
+    };
+
+private:
+    const fb::Variant *_p_variant;
+};
+
+} // namespace camellia
+
+#endif // CAMELLIA_VARIANT_VIEW_H